@@ -1,1268 +1,3542 @@
-// ==================== parallel_computation.h ====================
-#ifndef PARALLEL_COMPUTATION_H
-#define PARALLEL_COMPUTATION_H
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <unistd.h>
-#include <arpa/inet.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <pthread.h>
-#include <stdbool.h>
-#include <time.h>
-#include <errno.h>
-#include <ctype.h>
-
-#define MAX_WORKERS 100
-#define BUFFER_SIZE 1024
-#define MAX_COMMAND_LEN 32
-
-// ==================== Data Structures ====================
-
-typedef struct {
-    char ip[INET_ADDRSTRLEN];
-    int port;
-    int id;
-} WorkerInfo;
-
-typedef struct {
-    int socket;
-    int id;
-    char own_ip[INET_ADDRSTRLEN];
-    int own_port;
-    char right_neighbor_ip[INET_ADDRSTRLEN];
-    int right_neighbor_port;
-    bool has_right_neighbor;
-} WorkerConnection;
-
-typedef struct {
-    int *sockets;
-    WorkerInfo *worker_infos;
-    int worker_count;
-    char command[MAX_COMMAND_LEN];
-} CoordinatorResult;
-
-typedef struct {
-    int rank;
-    int size;
-    bool is_root;
-    
-    // Star topology connections
-    int *connections;
-    int connection_count;
-    
-    // Ring topology connections
-    int left_neighbor_socket;
-    int right_neighbor_socket;
-    bool has_left_neighbor;
-    bool has_right_neighbor;
-} Communicator;
-
-// Function pointer for algorithms
-typedef void* (*AlgorithmFunc)(Communicator*, int*, int);
-
-// ==================== Function Declarations ====================
-
-void* read_command_thread(void* arg);
-
-// Connection setup functions
-CoordinatorResult* setup_coordinator(const char* ip, int port);
-WorkerConnection* connect_to_coordinator(const char* worker_ip, int worker_port,
-                                        const char* coordinator_ip, int coordinator_port);
-void free_coordinator_result(CoordinatorResult* result);
-void free_worker_connection(WorkerConnection* conn);
-
-// Communicator functions
-Communicator* create_coordinator_communicator(int rank, int* worker_sockets, 
-                                            int worker_count, WorkerInfo* first_worker);
-Communicator* create_worker_communicator(int rank, int coordinator_socket,
-                                       const char* own_ip, int own_port,
-                                       const char* right_neighbor_ip, int right_neighbor_port);
-void free_communicator(Communicator* comm);
-
-// Communication operations
-void send_int(Communicator* comm, int value, int dest);
-int receive_int(Communicator* comm, int source);
-void send_int_array(Communicator* comm, int* data, int length, int dest);
-int* receive_int_array(Communicator* comm, int source, int* length);
-int reduce_int(Communicator* comm, int value, int (*op)(int, int));
-bool reduce_bool(Communicator* comm, bool value);
-void broadcast_string(Communicator* comm, const char* message);
-char* receive_broadcast(Communicator* comm);
-void barrier(Communicator* comm);
-int* scatter(Communicator* comm, int* data, int* chunk_sizes, int* my_chunk_size);
-int** gather(Communicator* comm, int* data, int length);
-
-// Neighbor communication
-void send_to_left_neighbor(Communicator* comm, int value);
-void send_to_right_neighbor(Communicator* comm, int value);
-int receive_from_left_neighbor(Communicator* comm);
-int receive_from_right_neighbor(Communicator* comm);
-
-// Algorithm functions
-void* sum_algorithm(Communicator* comm, int* local_data, int length);
-void* min_algorithm(Communicator* comm, int* local_data, int length);
-void* max_algorithm(Communicator* comm, int* local_data, int length);
-void* sort_algorithm(Communicator* comm, int* local_data, int length);
-
-// Utility functions
-int* create_random_array(int length);
-int* calculate_chunk_sizes(int array_length, int num_processes);
-void quick_sort(int* arr, int length);
-void insert_from_left(int* arr, int length);
-void insert_from_right(int* arr, int length);
-bool validate_sum(int calculated_sum, int* original_array, int length);
-bool validate_min(int calculated_min, int* original_array, int length);
-bool validate_max(int calculated_max, int* original_array, int length);
-bool is_sorted(int* array, int length);
-
-// Helper functions
-int min_op(int a, int b);
-int max_op(int a, int b);
-int sum_op(int a, int b);
-
-#endif
-
-// ==================== parallel_computation.c ===================
-
-// ==================== Main Program ====================
-
-int main(int argc, char* argv[]) {
-    if (argc < 4) {
-        printf("Usage:\nCoordinator: c <ownIP> <ownPort>\n");
-        printf("Worker: w <ownIP> <ownPort> <coordinatorIP> <coordinatorPort>\n");
-        return 1;
-    }
-    
-    bool is_coordinator = (argv[1][0] == 'c' || argv[1][0] == 'C');
-    char* own_ip = argv[2];
-    int own_port = atoi(argv[3]);
-    
-    if (is_coordinator) {
-        // Run as coordinator
-        CoordinatorResult* result = setup_coordinator(own_ip, own_port);
-        if (!result) {
-            fprintf(stderr, "Failed to setup coordinator\n");
-            return 1;
-        }
-        
-        // Create communicator
-        WorkerInfo* first_worker = (result->worker_count > 0) ? &result->worker_infos[0] : NULL;
-        Communicator* comm = create_coordinator_communicator(0, result->sockets, 
-                                                           result->worker_count, first_worker);
-        
-        // Create initial array
-        int array_length = 100;
-        int* initial_array = create_random_array(array_length);
-        printf("[Coordinator] Created initial array of length %d\n", array_length);
-        
-        // Execute command
-        printf("[Coordinator] Executing command: %s\n", result->command);
-        
-        // Distribute array
-        int* chunk_sizes = calculate_chunk_sizes(array_length, comm->size);
-        int my_chunk_size;
-        int* chunk = scatter(comm, initial_array, chunk_sizes, &my_chunk_size);
-        
-        printf("[Coordinator] Array distributed. My chunk: [");
-        for (int i = 0; i < my_chunk_size; i++) {
-            printf("%d%s", chunk[i], (i < my_chunk_size - 1) ? ", " : "");
-        }
-        printf("]\n");
-        
-        // Broadcast command
-        broadcast_string(comm, result->command);
-        
-        // Execute algorithm
-        AlgorithmFunc algorithm = NULL;
-        if (strcasecmp(result->command, "SUM") == 0) {
-            algorithm = sum_algorithm;
-        } else if (strcasecmp(result->command, "MIN") == 0) {
-            algorithm = min_algorithm;
-        } else if (strcasecmp(result->command, "MAX") == 0) {
-            algorithm = max_algorithm;
-        } else if (strcasecmp(result->command, "SORT") == 0) {
-            algorithm = sort_algorithm;
-        }
-        
-        void* result_value = NULL;
-        if (algorithm) {
-            result_value = algorithm(comm, chunk, my_chunk_size);
-        }
-        
-        // Display results
-        if (result_value) {
-            if (strcasecmp(result->command, "SUM") == 0) {
-                int sum = *(int*)result_value;
-                printf("[Coordinator] Final Sum: %d\n", sum);
-                printf("[Coordinator] Correct? %s\n", 
-                       validate_sum(sum, initial_array, array_length) ? "true" : "false");
-                free(result_value);
-            } else if (strcasecmp(result->command, "MIN") == 0) {
-                int min = *(int*)result_value;
-                printf("[Coordinator] Final Min: %d\n", min);
-                printf("[Coordinator] Correct? %s\n", 
-                       validate_min(min, initial_array, array_length) ? "true" : "false");
-                free(result_value);
-            } else if (strcasecmp(result->command, "MAX") == 0) {
-                int max = *(int*)result_value;
-                printf("[Coordinator] Final Max: %d\n", max);
-                printf("[Coordinator] Correct? %s\n", 
-                       validate_max(max, initial_array, array_length) ? "true" : "false");
-                free(result_value);
-            } else if (strcasecmp(result->command, "SORT") == 0) {
-                int* sorted = (int*)result_value;
-                printf("[Coordinator] Final sorted array: [");
-                for (int i = 0; i < array_length; i++) {
-                    printf("%d%s", sorted[i], (i < array_length - 1) ? ", " : "");
-                }
-                printf("]\n");
-                printf("[Coordinator] Correctly sorted? %s\n", 
-                       is_sorted(sorted, array_length) ? "true" : "false");
-                free(sorted);
-            }
-        }
-        
-        // Cleanup
-        barrier(comm);
-        printf("[Coordinator] Shutting down...\n");
-        free(chunk);
-        free(chunk_sizes);
-        free(initial_array);
-        free_communicator(comm);
-        free_coordinator_result(result);
-        printf("[Coordinator] Goodbye!\n");
-        
-    } else {
-        // Run as worker
-        if (argc < 6) {
-            printf("Usage for Worker: w <ownIP> <ownPort> <coordinatorIP> <coordinatorPort>\n");
-            return 1;
-        }
-        
-        char* coordinator_ip = argv[4];
-        int coordinator_port = atoi(argv[5]);
-        
-        WorkerConnection* conn = connect_to_coordinator(own_ip, own_port, 
-                                                       coordinator_ip, coordinator_port);
-        if (!conn) {
-            fprintf(stderr, "Failed to connect to coordinator\n");
-            return 1;
-        }
-        
-        // Create communicator
-        Communicator* comm = create_worker_communicator(conn->id, conn->socket,
-                                                       conn->own_ip, conn->own_port,
-                                                       conn->right_neighbor_ip, 
-                                                       conn->right_neighbor_port);
-        
-        printf("[Worker %d] Ready and waiting for data...\n", comm->rank);
-        
-        // Receive array chunk
-        int chunk_length;
-        int* chunk = receive_int_array(comm, 0, &chunk_length);
-        printf("[Worker %d] Received chunk: [", comm->rank);
-        for (int i = 0; i < chunk_length; i++) {
-            printf("%d%s", chunk[i], (i < chunk_length - 1) ? ", " : "");
-        }
-        printf("]\n");
-        
-        // Receive command
-        char* command = receive_broadcast(comm);
-        printf("[Worker %d] Received command: %s\n", comm->rank, command);
-        
-        // Execute algorithm
-        AlgorithmFunc algorithm = NULL;
-        if (strcasecmp(command, "SUM") == 0) {
-            algorithm = sum_algorithm;
-        } else if (strcasecmp(command, "MIN") == 0) {
-            algorithm = min_algorithm;
-        } else if (strcasecmp(command, "MAX") == 0) {
-            algorithm = max_algorithm;
-        } else if (strcasecmp(command, "SORT") == 0) {
-            algorithm = sort_algorithm;
-        }
-        
-        if (algorithm) {
-            algorithm(comm, chunk, chunk_length);
-        }
-        
-        // Cleanup
-        // Cleanup
-        barrier(comm);
-        printf("[Worker %d] Shutting down...\n", comm->rank);
-        
-        int worker_id = comm->rank;  // NEU: Speichern vor dem Freigeben
-        
-        free(chunk);
-        free(command);
-        free_communicator(comm);
-        free_worker_connection(conn);
-        printf("[Worker %d] Worker terminated.\n", worker_id);  // GEÄNDERT: worker_id statt conn->id
-    }
-    
-    return 0;
-}
-
-// ==================== Connection Setup Implementation ====================
-
-CoordinatorResult* setup_coordinator(const char* ip, int port) {
-    int server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket < 0) {
-        perror("Socket creation failed");
-        return NULL;
-    }
-    
-    // Allow socket reuse
-    int opt = 1;
-    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-    
-    struct sockaddr_in server_addr;
-    server_addr.sin_family = AF_INET;
-    server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(port);
-    
-    if (bind(server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
-        perror("Bind failed");
-        close(server_socket);
-        return NULL;
-    }
-    
-    if (listen(server_socket, MAX_WORKERS) < 0) {
-        perror("Listen failed");
-        close(server_socket);
-        return NULL;
-    }
-    
-    printf("[Coordinator] Server started on %s:%d\n", ip, port);
-    printf("[Coordinator] Waiting for workers...\n\n");
-    printf("=== Available Commands ===\n");
-    printf("  SUM  - Calculate sum of array\n");
-    printf("  MIN  - Find minimum of array\n");
-    printf("  MAX  - Find maximum of array\n");
-    printf("  SORT - Sort array using odd-even transposition\n");
-    printf("===========================\n");
-    printf("Enter command when all workers are connected:\n");
-    
-    CoordinatorResult* result = malloc(sizeof(CoordinatorResult));
-    result->sockets = malloc(MAX_WORKERS * sizeof(int));
-    result->worker_infos = malloc(MAX_WORKERS * sizeof(WorkerInfo));
-    result->worker_count = 0;
-    
-    // Thread for reading command
-    pthread_t command_thread;
-    struct {
-        char command[MAX_COMMAND_LEN];
-        bool ready;
-        int server_socket;
-    } command_data = { .command = "", .ready = false, .server_socket = server_socket };
-    
-    pthread_create(&command_thread, NULL, (void*)read_command_thread, &command_data);
-    
-    // Accept workers
-    int current_id = 1;
-    while (!command_data.ready && result->worker_count < MAX_WORKERS) {
-        struct sockaddr_in worker_addr;
-        socklen_t addr_len = sizeof(worker_addr);
-        
-        int worker_socket = accept(server_socket, (struct sockaddr*)&worker_addr, &addr_len);
-        if (worker_socket < 0) {
-            if (command_data.ready) break;
-            continue;
-        }
-        
-        // Read registration
-        char buffer[BUFFER_SIZE];
-        recv(worker_socket, buffer, BUFFER_SIZE, 0);
-        
-        if (strncmp(buffer, "REGISTRATION:", 13) == 0) {
-            char worker_ip[INET_ADDRSTRLEN];
-            int worker_port;
-            sscanf(buffer + 13, "%[^:]:%d", worker_ip, &worker_port);
-            
-            result->sockets[result->worker_count] = worker_socket;
-            strcpy(result->worker_infos[result->worker_count].ip, worker_ip);
-            result->worker_infos[result->worker_count].port = worker_port;
-            result->worker_infos[result->worker_count].id = current_id;
-            
-            printf("[Coordinator] Worker %d registered from %s:%d\n", 
-                   current_id, worker_ip, worker_port);
-            
-            // Send ID to worker
-            send(worker_socket, &current_id, sizeof(int), 0);
-            
-            result->worker_count++;
-            current_id++;
-            
-            printf("[Coordinator] Total workers connected: %d\n", result->worker_count);
-            printf("Coordinator> ");
-            fflush(stdout);
-        }
-    }
-    
-    // Wait for command thread
-    pthread_join(command_thread, NULL);
-    strcpy(result->command, command_data.command);
-    
-    // Send neighbor information
-    for (int i = 0; i < result->worker_count; i++) {
-        bool has_right = (i < result->worker_count - 1);
-        send(result->sockets[i], &has_right, sizeof(bool), 0);
-        
-        if (has_right) {
-            send(result->sockets[i], result->worker_infos[i + 1].ip, INET_ADDRSTRLEN, 0);
-            send(result->sockets[i], &result->worker_infos[i + 1].port, sizeof(int), 0);
-        }
-    }
-    
-    close(server_socket);
-    printf("[Coordinator] Network setup complete with %d workers.\n", result->worker_count);
-    printf("[Coordinator] Will execute command: %s\n", result->command);
-    
-    return result;
-}
-
-void* read_command_thread(void* arg) {
-    struct {
-        char command[MAX_COMMAND_LEN];
-        bool ready;
-        int server_socket;
-    }* data = arg;
-    
-    char input[MAX_COMMAND_LEN];
-    while (!data->ready) {
-        printf("Coordinator> ");
-        fflush(stdout);
-        
-        if (fgets(input, MAX_COMMAND_LEN, stdin)) {
-            input[strcspn(input, "\n")] = 0; // Remove newline
-            
-            // Convert to uppercase
-            for (int i = 0; input[i]; i++) {
-                input[i] = toupper(input[i]);
-            }
-            
-            if (strcmp(input, "SUM") == 0 || strcmp(input, "MIN") == 0 || 
-                strcmp(input, "MAX") == 0 || strcmp(input, "SORT") == 0) {
-                strcpy(data->command, input);
-                data->ready = true;
-                printf("[Coordinator] Command '%s' received. Stopping worker registration...\n", input);
-                shutdown(data->server_socket, SHUT_RDWR);
-                close(data->server_socket);
-                break;
-            } else {
-                printf("Invalid command. Available: SUM, MIN, MAX, SORT\n");
-            }
-        }
-    }
-    return NULL;
-}
-
-WorkerConnection* connect_to_coordinator(const char* worker_ip, int worker_port,
-                                       const char* coordinator_ip, int coordinator_port) {
-    printf("[Worker] Connecting to coordinator at %s:%d...\n", coordinator_ip, coordinator_port);
-    
-    int sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock < 0) {
-        perror("Socket creation failed");
-        return NULL;
-    }
-    
-    struct sockaddr_in coord_addr;
-    coord_addr.sin_family = AF_INET;
-    coord_addr.sin_port = htons(coordinator_port);
-    inet_pton(AF_INET, coordinator_ip, &coord_addr.sin_addr);
-    
-    if (connect(sock, (struct sockaddr*)&coord_addr, sizeof(coord_addr)) < 0) {
-        perror("Connection failed");
-        close(sock);
-        return NULL;
-    }
-    
-    // Send registration
-    char registration[BUFFER_SIZE];
-    snprintf(registration, BUFFER_SIZE, "REGISTRATION:%s:%d", worker_ip, worker_port);
-    send(sock, registration, strlen(registration) + 1, 0);
-    
-    // Receive ID
-    int worker_id;
-    recv(sock, &worker_id, sizeof(int), 0);
-    
-    // Receive neighbor info
-    bool has_right_neighbor;
-    recv(sock, &has_right_neighbor, sizeof(bool), 0);
-    
-    WorkerConnection* conn = malloc(sizeof(WorkerConnection));
-    conn->socket = sock;
-    conn->id = worker_id;
-    strcpy(conn->own_ip, worker_ip);
-    conn->own_port = worker_port;
-    conn->has_right_neighbor = has_right_neighbor;
-    
-    if (has_right_neighbor) {
-        recv(sock, conn->right_neighbor_ip, INET_ADDRSTRLEN, 0);
-        recv(sock, &conn->right_neighbor_port, sizeof(int), 0);
-        printf("[Worker] Successfully connected with ID: %d\n", worker_id);
-        printf("[Worker] Right neighbor at: %s:%d\n", 
-               conn->right_neighbor_ip, conn->right_neighbor_port);
-    } else {
-        conn->right_neighbor_port = -1;
-        printf("[Worker] Successfully connected with ID: %d\n", worker_id);
-        printf("[Worker] No right neighbor (last worker)\n");
-    }
-    
-    return conn;
-}
-
-// ==================== Communicator Implementation ====================
-
-Communicator* create_coordinator_communicator(int rank, int* worker_sockets, 
-                                            int worker_count, WorkerInfo* first_worker) {
-    Communicator* comm = malloc(sizeof(Communicator));
-    comm->rank = 0;
-    comm->is_root = true;
-    comm->size = worker_count + 1;
-    
-    // Star topology
-    comm->connection_count = worker_count;
-    comm->connections = malloc(worker_count * sizeof(int));
-    memcpy(comm->connections, worker_sockets, worker_count * sizeof(int));
-    
-    // Ring topology - connect to first worker if exists
-    comm->left_neighbor_socket = -1;
-    comm->has_left_neighbor = false;
-    comm->right_neighbor_socket = -1;
-    comm->has_right_neighbor = false;
-    
-    if (first_worker) {
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(first_worker->port);
-        inet_pton(AF_INET, first_worker->ip, &addr.sin_addr);
-        
-        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
-            comm->right_neighbor_socket = sock;
-            comm->has_right_neighbor = true;
-            printf("[Coordinator] Connected to right neighbor (Worker 1)\n");
-        }
-    }
-    
-    return comm;
-}
-
-Communicator* create_worker_communicator(int rank, int coordinator_socket,
-                                       const char* own_ip, int own_port,
-                                       const char* right_neighbor_ip, int right_neighbor_port) {
-    Communicator* comm = malloc(sizeof(Communicator));
-    comm->rank = rank;
-    comm->is_root = false;
-    comm->size = -1; // Workers don't know total size
-    
-    // Star topology - connection to coordinator
-    comm->connection_count = 1;
-    comm->connections = malloc(sizeof(int));
-    comm->connections[0] = coordinator_socket;
-    
-    // Ring topology
-    comm->left_neighbor_socket = -1;
-    comm->has_left_neighbor = false;
-    comm->right_neighbor_socket = -1;
-    comm->has_right_neighbor = false;
-    
-    // Accept connection from left neighbor
-    if (rank > 1) {
-        int server_sock = socket(AF_INET, SOCK_STREAM, 0);
-        int opt = 1;
-        setsockopt(server_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-        
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = INADDR_ANY;
-        addr.sin_port = htons(own_port);
-        
-        bind(server_sock, (struct sockaddr*)&addr, sizeof(addr));
-        listen(server_sock, 1);
-        
-        printf("[Worker %d] Waiting for left neighbor connection...\n", rank);
-        comm->left_neighbor_socket = accept(server_sock, NULL, NULL);
-        comm->has_left_neighbor = true;
-        close(server_sock);
-        printf("[Worker %d] Left neighbor connected\n", rank);
-    } else if (rank == 1) {
-        // Worker 1 accepts from coordinator
-        int server_sock = socket(AF_INET, SOCK_STREAM, 0);
-        int opt = 1;
-        setsockopt(server_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-        
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_addr.s_addr = INADDR_ANY;
-        addr.sin_port = htons(own_port);
-        
-        bind(server_sock, (struct sockaddr*)&addr, sizeof(addr));
-        listen(server_sock, 1);
-        
-        printf("[Worker 1] Waiting for coordinator connection...\n");
-        comm->left_neighbor_socket = accept(server_sock, NULL, NULL);
-        comm->has_left_neighbor = true;
-        close(server_sock);
-        printf("[Worker 1] Coordinator connected as left neighbor\n");
-    }
-    
-    // Connect to right neighbor if exists
-    if (right_neighbor_port > 0) {
-        int sock = socket(AF_INET, SOCK_STREAM, 0);
-        struct sockaddr_in addr;
-        addr.sin_family = AF_INET;
-        addr.sin_port = htons(right_neighbor_port);
-        inet_pton(AF_INET, right_neighbor_ip, &addr.sin_addr);
-        
-        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
-            comm->right_neighbor_socket = sock;
-            comm->has_right_neighbor = true;
-            printf("[Worker %d] Connected to right neighbor\n", rank);
-        }
-    }
-    
-    return comm;
-}
-
-void free_communicator(Communicator* comm) {
-    if (comm->connections) {
-        for (int i = 0; i < comm->connection_count; i++) {
-            close(comm->connections[i]);
-        }
-        free(comm->connections);
-    }
-    
-    if (comm->left_neighbor_socket >= 0) close(comm->left_neighbor_socket);
-    if (comm->right_neighbor_socket >= 0) close(comm->right_neighbor_socket);
-    
-    free(comm);
-}
-
-// ==================== Communication Operations ====================
-
-void send_int(Communicator* comm, int value, int dest) {
-    int sock = -1;
-    
-    if (comm->is_root && dest > 0 && dest <= comm->connection_count) {
-        sock = comm->connections[dest - 1];
-    } else if (!comm->is_root && dest == 0) {
-        sock = comm->connections[0];
-    }
-    
-    if (sock >= 0) {
-        send(sock, &value, sizeof(int), 0);
-    }
-}
-
-int receive_int(Communicator* comm, int source) {
-    int sock = -1;
-    
-    if (comm->is_root && source > 0 && source <= comm->connection_count) {
-        sock = comm->connections[source - 1];
-    } else if (!comm->is_root && source == 0) {
-        sock = comm->connections[0];
-    }
-    
-    int value = 0;
-    if (sock >= 0) {
-        recv(sock, &value, sizeof(int), 0);
-    }
-    
-    return value;
-}
-
-void send_int_array(Communicator* comm, int* data, int length, int dest) {
-    int sock = -1;
-    
-    if (comm->is_root && dest > 0 && dest <= comm->connection_count) {
-        sock = comm->connections[dest - 1];
-    } else if (!comm->is_root && dest == 0) {
-        sock = comm->connections[0];
-    }
-    
-    if (sock >= 0) {
-        send(sock, &length, sizeof(int), 0);
-        send(sock, data, length * sizeof(int), 0);
-    }
-}
-
-int* receive_int_array(Communicator* comm, int source, int* length) {
-    int sock = -1;
-    
-    if (comm->is_root && source > 0 && source <= comm->connection_count) {
-        sock = comm->connections[source - 1];
-    } else if (!comm->is_root && source == 0) {
-        sock = comm->connections[0];
-    }
-    
-    if (sock >= 0) {
-        recv(sock, length, sizeof(int), 0);
-        int* data = malloc(*length * sizeof(int));
-        recv(sock, data, *length * sizeof(int), 0);
-        return data;
-    }
-    
-    *length = 0;
-    return NULL;
-}
-
-int reduce_int(Communicator* comm, int value, int (*op)(int, int)) {
-    if (comm->is_root) {
-        int result = value;
-        for (int i = 1; i < comm->size; i++) {
-            int worker_value = receive_int(comm, i);
-            result = op(result, worker_value);
-        }
-        return result;
-    } else {
-        send_int(comm, value, 0);
-        return value;
-    }
-}
-
-bool reduce_bool(Communicator* comm, bool value) {
-    int int_value = value ? 1 : 0;
-    int result = reduce_int(comm, int_value, max_op);
-    return result != 0;
-}
-
-void broadcast_string(Communicator* comm, const char* message) {
-    if (!comm->is_root) return;
-    
-    int len = strlen(message) + 1;
-    for (int i = 0; i < comm->connection_count; i++) {
-        send(comm->connections[i], &len, sizeof(int), 0);
-        send(comm->connections[i], message, len, 0);
-    }
-}
-
-char* receive_broadcast(Communicator* comm) {
-    if (comm->is_root) return NULL;
-    
-    int len;
-    recv(comm->connections[0], &len, sizeof(int), 0);
-    
-    char* message = malloc(len);
-    recv(comm->connections[0], message, len, 0);
-    
-    return message;
-}
-
-void barrier(Communicator* comm) {
-    if (comm->is_root) {
-        // Receive from all workers
-        for (int i = 1; i < comm->size; i++) {
-            receive_int(comm, i);
-        }
-        // Send acknowledgment to all
-        for (int i = 1; i < comm->size; i++) {
-            send_int(comm, 1, i);
-        }
-    } else {
-        send_int(comm, 1, 0);
-        receive_int(comm, 0);
-    }
-}
-
-int* scatter(Communicator* comm, int* data, int* chunk_sizes, int* my_chunk_size) {
-    if (comm->is_root) {
-        int index = chunk_sizes[0];
-        
-        // Send chunks to workers
-        for (int i = 1; i < comm->size; i++) {
-            send_int_array(comm, &data[index], chunk_sizes[i], i);
-            index += chunk_sizes[i];
-        }
-        
-        // Return coordinator's chunk
-        *my_chunk_size = chunk_sizes[0];
-        int* my_chunk = malloc(chunk_sizes[0] * sizeof(int));
-        memcpy(my_chunk, data, chunk_sizes[0] * sizeof(int));
-        return my_chunk;
-    } else {
-        return receive_int_array(comm, 0, my_chunk_size);
-    }
-}
-
-int** gather(Communicator* comm, int* data, int length) {
-    if (comm->is_root) {
-        int** all_data = malloc(comm->size * sizeof(int*));
-        
-        // Store coordinator's data
-        all_data[0] = malloc(length * sizeof(int));
-        memcpy(all_data[0], data, length * sizeof(int));
-        
-        // Receive from workers
-        for (int i = 1; i < comm->size; i++) {
-            int worker_length;
-            all_data[i] = receive_int_array(comm, i, &worker_length);
-        }
-        
-        return all_data;
-    } else {
-        send_int_array(comm, data, length, 0);
-        return NULL;
-    }
-}
-
-// ==================== Neighbor Communication ====================
-
-void send_to_left_neighbor(Communicator* comm, int value) {
-    if (comm->has_left_neighbor) {
-        send(comm->left_neighbor_socket, &value, sizeof(int), 0);
-    }
-}
-
-void send_to_right_neighbor(Communicator* comm, int value) {
-    if (comm->has_right_neighbor) {
-        send(comm->right_neighbor_socket, &value, sizeof(int), 0);
-    }
-}
-
-int receive_from_left_neighbor(Communicator* comm) {
-    int value = 0;
-    if (comm->has_left_neighbor) {
-        recv(comm->left_neighbor_socket, &value, sizeof(int), 0);
-    }
-    return value;
-}
-
-int receive_from_right_neighbor(Communicator* comm) {
-    int value = 0;
-    if (comm->has_right_neighbor) {
-        recv(comm->right_neighbor_socket, &value, sizeof(int), 0);
-    }
-    return value;
-}
-
-// ==================== Algorithm Implementations ====================
-
-void* sum_algorithm(Communicator* comm, int* local_data, int length) {
-    int local_sum = 0;
-    for (int i = 0; i < length; i++) {
-        local_sum += local_data[i];
-    }
-    
-    printf("[Rank %d] Local sum: %d\n", comm->rank, local_sum);
-    
-    if (comm->is_root) {
-        int result = reduce_int(comm, local_sum, sum_op);
-        int* result_ptr = malloc(sizeof(int));
-        *result_ptr = result;
-        return result_ptr;
-    } else {
-        reduce_int(comm, local_sum, sum_op);
-        return NULL;
-    }
-}
-
-void* min_algorithm(Communicator* comm, int* local_data, int length) {
-    int local_min = local_data[0];
-    for (int i = 1; i < length; i++) {
-        if (local_data[i] < local_min) {
-            local_min = local_data[i];
-        }
-    }
-    
-    printf("[Rank %d] Local minimum: %d\n", comm->rank, local_min);
-    
-    if (comm->is_root) {
-        int result = reduce_int(comm, local_min, min_op);
-        int* result_ptr = malloc(sizeof(int));
-        *result_ptr = result;
-        return result_ptr;
-    } else {
-        reduce_int(comm, local_min, min_op);
-        return NULL;
-    }
-}
-
-void* max_algorithm(Communicator* comm, int* local_data, int length) {
-    int local_max = local_data[0];
-    for (int i = 1; i < length; i++) {
-        if (local_data[i] > local_max) {
-            local_max = local_data[i];
-        }
-    }
-    
-    printf("[Rank %d] Local maximum: %d\n", comm->rank, local_max);
-    
-    if (comm->is_root) {
-        int result = reduce_int(comm, local_max, max_op);
-        int* result_ptr = malloc(sizeof(int));
-        *result_ptr = result;
-        return result_ptr;
-    } else {
-        reduce_int(comm, local_max, max_op);
-        return NULL;
-    }
-}
-
-// ==================== Parallel Sort Implementation ====================
-
-typedef struct {
-    Communicator* comm;
-    int* local_data;
-    int length;
-} SortContext;
-
-bool execute_phase(SortContext* ctx, const char* phase);
-bool exchange_with_right(SortContext* ctx);
-bool receive_from_left(SortContext* ctx);
-void presort(int* data, int length);
-
-void* sort_algorithm(Communicator* comm, int* local_data, int length) {
-    SortContext ctx = {comm, local_data, length};
-    
-    // Phase 1: Synchronized presort
-    if (comm->is_root) {
-        broadcast_string(comm, "PRESORT");
-    } else {
-        char* cmd = receive_broadcast(comm);
-        free(cmd);
-    }
-    
-    presort(local_data, length);
-    
-    barrier(comm);
-    printf("[Rank %d] Presort completed, waiting at barrier\n", comm->rank);
-    
-    // Phase 2: Odd-Even rounds
-    bool global_swapped = true;
-    int round = 0;
-    
-    while (global_swapped) {
-        round++;
-        printf("\n[Rank %d] ========== ROUND %d ==========\n", comm->rank, round);
-        
-        // ODD phase
-        if (comm->is_root) {
-            broadcast_string(comm, "ODD");
-        } else {
-            char* phase = receive_broadcast(comm);
-            free(phase);
-        }
-        
-        printf("[Rank %d] ODD PHASE - Array before: [", comm->rank);
-        for (int i = 0; i < length; i++) {
-            printf("%d%s", local_data[i], (i < length - 1) ? ", " : "");
-        }
-        printf("]\n");
-        
-        bool local_odd_swap = execute_phase(&ctx, "ODD");
-        bool global_odd_swap = reduce_bool(comm, local_odd_swap);
-        
-        // EVEN phase
-        if (comm->is_root) {
-            broadcast_string(comm, "EVEN");
-        } else {
-            char* phase = receive_broadcast(comm);
-            free(phase);
-        }
-        
-        printf("[Rank %d] EVEN PHASE - Array before: [", comm->rank);
-        for (int i = 0; i < length; i++) {
-            printf("%d%s", local_data[i], (i < length - 1) ? ", " : "");
-        }
-        printf("]\n");
-        
-        bool local_even_swap = execute_phase(&ctx, "EVEN");
-        bool global_even_swap = reduce_bool(comm, local_even_swap);
-        
-        // Check if we should continue
-        if (comm->is_root) {
-            global_swapped = global_odd_swap || global_even_swap;
-            printf("[Coordinator] Round %d complete. Global swaps: %s\n", 
-                   round, global_swapped ? "true" : "false");
-            
-            broadcast_string(comm, global_swapped ? "CONTINUE" : "DONE");
-        } else {
-            char* decision = receive_broadcast(comm);
-            global_swapped = (strcmp(decision, "CONTINUE") == 0);
-            free(decision);
-        }
-    }
-    
-    // Phase 3: Gather sorted data
-    if (comm->is_root) {
-        broadcast_string(comm, "GATHER");
-        int** all_chunks = gather(comm, local_data, length);
-        
-        // Calculate total size
-        int* chunk_sizes = calculate_chunk_sizes(100, comm->size); // Assuming original array size 100
-        int total_size = 0;
-        for (int i = 0; i < comm->size; i++) {
-            total_size += chunk_sizes[i];
-        }
-        
-        // Merge results
-        int* final_result = malloc(total_size * sizeof(int));
-        int index = 0;
-        for (int i = 0; i < comm->size; i++) {
-            memcpy(&final_result[index], all_chunks[i], chunk_sizes[i] * sizeof(int));
-            index += chunk_sizes[i];
-            free(all_chunks[i]);
-        }
-        
-        free(all_chunks);
-        free(chunk_sizes);
-        return final_result;
-    } else {
-        char* gather_cmd = receive_broadcast(comm);
-        free(gather_cmd);
-        gather(comm, local_data, length);
-        return NULL;
-    }
-}
-
-bool execute_phase(SortContext* ctx, const char* phase) {
-    bool is_odd_phase = (strcmp(phase, "ODD") == 0);
-    bool is_active = (ctx->comm->rank % 2 == 1 && is_odd_phase) || 
-                     (ctx->comm->rank % 2 == 0 && !is_odd_phase);
-    
-    if (is_active && ctx->comm->has_right_neighbor) {
-        printf("[Rank %d] %s PHASE: I am ACTIVE, exchanging with right neighbor\n", 
-               ctx->comm->rank, phase);
-        return exchange_with_right(ctx);
-    } else if (!is_active && ctx->comm->has_left_neighbor) {
-        printf("[Rank %d] %s PHASE: I am PASSIVE, waiting for left neighbor\n", 
-               ctx->comm->rank, phase);
-        return receive_from_left(ctx);
-    } else {
-        printf("[Rank %d] %s PHASE: No neighbor to exchange with\n", 
-               ctx->comm->rank, phase);
-        return false;
-    }
-}
-
-bool exchange_with_right(SortContext* ctx) {
-    int my_value = ctx->local_data[ctx->length - 1];
-    printf("[Rank %d] ACTIVE: Sending to right: %d\n", ctx->comm->rank, my_value);
-    
-    send_to_right_neighbor(ctx->comm, my_value);
-    int neighbor_value = receive_from_right_neighbor(ctx->comm);
-    printf("[Rank %d] ACTIVE: Received from right: %d\n", ctx->comm->rank, neighbor_value);
-    
-    if (my_value > neighbor_value) {
-        printf("[Rank %d] ACTIVE: SWAP! My %d > neighbor's %d\n", 
-               ctx->comm->rank, my_value, neighbor_value);
-        ctx->local_data[ctx->length - 1] = neighbor_value;
-        insert_from_right(ctx->local_data, ctx->length);
-        
-        printf("[Rank %d] ACTIVE: Array after swap: [", ctx->comm->rank);
-        for (int i = 0; i < ctx->length; i++) {
-            printf("%d%s", ctx->local_data[i], (i < ctx->length - 1) ? ", " : "");
-        }
-        printf("]\n");
-        return true;
-    }
-    
-    printf("[Rank %d] ACTIVE: NO SWAP - My %d <= neighbor's %d\n", 
-           ctx->comm->rank, my_value, neighbor_value);
-    return false;
-}
-
-bool receive_from_left(SortContext* ctx) {
-    int received_value = receive_from_left_neighbor(ctx->comm);
-    int my_value = ctx->local_data[0];
-    
-    printf("[Rank %d] PASSIVE: Received from left: %d\n", ctx->comm->rank, received_value);
-    printf("[Rank %d] PASSIVE: My first value: %d\n", ctx->comm->rank, my_value);
-    
-    if (received_value > my_value) {
-        printf("[Rank %d] PASSIVE: SWAP! Neighbor's %d > my %d\n", 
-               ctx->comm->rank, received_value, my_value);
-        send_to_left_neighbor(ctx->comm, my_value);
-        printf("[Rank %d] PASSIVE: Sent back to left: %d\n", ctx->comm->rank, my_value);
-        
-        ctx->local_data[0] = received_value;
-        insert_from_left(ctx->local_data, ctx->length);
-        
-        printf("[Rank %d] PASSIVE: Array after swap: [", ctx->comm->rank);
-        for (int i = 0; i < ctx->length; i++) {
-            printf("%d%s", ctx->local_data[i], (i < ctx->length - 1) ? ", " : "");
-        }
-        printf("]\n");
-        return true;
-    } else {
-        printf("[Rank %d] PASSIVE: NO SWAP - Neighbor's %d <= my %d\n", 
-               ctx->comm->rank, received_value, my_value);
-        send_to_left_neighbor(ctx->comm, received_value);
-        printf("[Rank %d] PASSIVE: Sent back to left: %d\n", ctx->comm->rank, received_value);
-        return false;
-    }
-}
-
-void presort(int* data, int length) {
-    quick_sort(data, length);
-    printf("[Rank %d] Presorted: [", 0); // Will be filled with actual rank
-    for (int i = 0; i < length; i++) {
-        printf("%d%s", data[i], (i < length - 1) ? ", " : "");
-    }
-    printf("]\n");
-}
-
-// ==================== Utility Functions ====================
-
-int* create_random_array(int length) {
-    int* array = malloc(length * sizeof(int));
-    srand(time(NULL));
-    for (int i = 0; i < length; i++) {
-        array[i] = (rand() % 99) + 1;
-    }
-    return array;
-}
-
-int* calculate_chunk_sizes(int array_length, int num_processes) {
-    int* sizes = malloc(num_processes * sizeof(int));
-    int base_size = array_length / num_processes;
-    int remainder = array_length % num_processes;
-    
-    for (int i = 0; i < num_processes; i++) {
-        sizes[i] = base_size;
-        if (i < remainder) {
-            sizes[i]++;
-        }
-    }
-    
-    return sizes;
-}
-
-// QuickSort implementation
-void quick_sort_recursive(int* arr, int low, int high);
-int partition(int* arr, int low, int high);
-void swap(int* a, int* b);
-
-void quick_sort(int* arr, int length) {
-    quick_sort_recursive(arr, 0, length - 1);
-}
-
-void quick_sort_recursive(int* arr, int low, int high) {
-    if (low < high) {
-        int pivot_index = partition(arr, low, high);
-        quick_sort_recursive(arr, low, pivot_index - 1);
-        quick_sort_recursive(arr, pivot_index + 1, high);
-    }
-}
-
-int partition(int* arr, int low, int high) {
-    // Median-of-three pivot selection
-    int mid = low + (high - low) / 2;
-    if (arr[mid] < arr[low]) swap(&arr[low], &arr[mid]);
-    if (arr[high] < arr[low]) swap(&arr[low], &arr[high]);
-    if (arr[high] < arr[mid]) swap(&arr[mid], &arr[high]);
-    swap(&arr[mid], &arr[high]);
-    
-    int pivot = arr[high];
-    int i = low - 1;
-    
-    for (int j = low; j < high; j++) {
-        if (arr[j] <= pivot) {
-            i++;
-            swap(&arr[i], &arr[j]);
-        }
-    }
-    swap(&arr[i + 1], &arr[high]);
-    return i + 1;
-}
-
-void swap(int* a, int* b) {
-    int temp = *a;
-    *a = *b;
-    *b = temp;
-}
-
-void insert_from_left(int* arr, int length) {
-    int i = 0;
-    int temp = arr[i];
-    while (i + 1 < length && temp > arr[i + 1]) {
-        arr[i] = arr[i + 1];
-        i++;
-    }
-    arr[i] = temp;
-}
-
-void insert_from_right(int* arr, int length) {
-    int i = length - 1;
-    int temp = arr[i];
-    while (i - 1 >= 0 && temp < arr[i - 1]) {
-        arr[i] = arr[i - 1];
-        i--;
-    }
-    arr[i] = temp;
-}
-
-// Validation functions
-bool validate_sum(int calculated_sum, int* original_array, int length) {
-    int expected_sum = 0;
-    for (int i = 0; i < length; i++) {
-        expected_sum += original_array[i];
-    }
-    return calculated_sum == expected_sum;
-}
-
-bool validate_min(int calculated_min, int* original_array, int length) {
-    int expected_min = original_array[0];
-    for (int i = 1; i < length; i++) {
-        if (original_array[i] < expected_min) {
-            expected_min = original_array[i];
-        }
-    }
-    return calculated_min == expected_min;
-}
-
-bool validate_max(int calculated_max, int* original_array, int length) {
-    int expected_max = original_array[0];
-    for (int i = 1; i < length; i++) {
-        if (original_array[i] > expected_max) {
-            expected_max = original_array[i];
-        }
-    }
-    return calculated_max == expected_max;
-}
-
-bool is_sorted(int* array, int length) {
-    for (int i = 0; i < length - 1; i++) {
-        if (array[i] > array[i + 1]) {
-            return false;
-        }
-    }
-    return true;
-}
-
-// Helper operation functions
-int min_op(int a, int b) {
-    return (a < b) ? a : b;
-}
-
-int max_op(int a, int b) {
-    return (a > b) ? a : b;
-}
-
-int sum_op(int a, int b) {
-    return a + b;
-}
-
-// Cleanup functions
-void free_coordinator_result(CoordinatorResult* result) {
-    if (result) {
-        free(result->sockets);
-        free(result->worker_infos);
-        free(result);
-    }
-}
-
-void free_worker_connection(WorkerConnection* conn) {
-    if (conn) {
-        free(conn);
-    }
-}
-
-// Thread function declaration
-void* read_command_thread(void* arg);
+// ==================== parallel_computation.h ====================
+#ifndef PARALLEL_COMPUTATION_H
+#define PARALLEL_COMPUTATION_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
+#include <errno.h>
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <stdatomic.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <linux/errqueue.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#define BUFFER_SIZE 1024
+#define MAX_COMMAND_LEN 32
+#define DEFAULT_TREE_THRESHOLD 32
+#define DEFAULT_ARRAY_LENGTH 100
+#define PARALLEL_GRAIN 32768   // Minimum elements per thread pool task
+#define ZEROCOPY_THRESHOLD (256 * 1024)   // Payload bytes from which MSG_ZEROCOPY pays off
+#define SHM_RING_SIZE (1 << 20)           // Bytes per direction of a shared-memory link
+#define SHM_SPIN 200                      // Polls before sleeping on the futex
+#define SHM_WAIT_MS 100                   // Futex sleep between peer liveness checks
+
+// ==================== Data Structures ====================
+
+typedef struct {
+    char ip[INET_ADDRSTRLEN];
+    int port;
+    int id;
+} WorkerInfo;
+
+typedef struct {
+    int socket;
+    int id;
+    char own_ip[INET_ADDRSTRLEN];
+    int own_port;
+    char right_neighbor_ip[INET_ADDRSTRLEN];
+    int right_neighbor_port;
+    bool has_right_neighbor;
+    int size;
+    bool use_tree;
+    WorkerInfo *peer_infos;   // All workers, index rank - 1
+    int listen_socket;        // Opened before registering, see connect_to_coordinator
+} WorkerConnection;
+
+typedef struct {
+    int *sockets;
+    WorkerInfo *worker_infos;
+    int worker_count;
+    bool use_tree;
+    char command[MAX_COMMAND_LEN];
+} CoordinatorResult;
+
+typedef struct {
+    int rank;
+    int size;
+    bool is_root;
+    
+    // Star topology connections
+    int *connections;
+    int connection_count;
+    
+    // Ring topology connections
+    int left_neighbor_socket;
+    int right_neighbor_socket;
+    bool has_left_neighbor;
+    bool has_right_neighbor;
+    
+    // Binomial tree connections, used by the collectives if use_tree is set.
+    // The coordinator's children and a worker's link to a coordinator parent
+    // reuse the star sockets.
+    bool use_tree;
+    int tree_parent_socket;
+    int *tree_child_sockets;
+    int *tree_child_ranks;
+    int tree_child_count;
+    
+    // Direct links to every rank (index = rank), opened on first use by
+    // the all-to-all exchange. Links to rank 0 are the star sockets.
+    WorkerInfo *peer_infos;   // All workers, index rank - 1
+    int listen_socket;        // Workers keep accepting peer links here
+    int *peer_sockets;
+    
+    // The neighbor chain closed into a ring for the ring collectives. The
+    // closing link between rank P-1 and rank 0 is their star socket.
+    int ring_next_socket;
+    int ring_prev_socket;
+} Communicator;
+
+// Function pointer for algorithms
+typedef void* (*AlgorithmFunc)(Communicator*, int*, int);
+
+// Odd-even sort variants
+typedef enum {
+    SORT_MODE_BLOCK,    // Merge-split of whole chunks, at most P phases
+    SORT_MODE_ELEMENT   // One boundary element per exchange
+} SortMode;
+
+// Command line options (after the positional arguments)
+typedef struct {
+    SortMode sort_mode;
+    int tree_threshold;   // Use tree collectives from this many ranks on
+    bool session;         // Coordinator keeps reading jobs from stdin
+    int threads;          // Compute threads per rank, 0 = number of cores
+    const char* input_path;    // Coordinator: binary int array to scatter
+    const char* output_path;   // Coordinator: sorted result is written here
+    bool shm;             // Shared memory instead of TCP between ranks on one host
+    int expect;           // Coordinator: close registration after this many workers
+    int register_timeout; // Coordinator: close registration after this many seconds
+} Options;
+
+// Binary file of native ints mapped into memory (--input / --output)
+typedef struct {
+    int* data;
+    int length;
+    size_t size;   // Mapped bytes, 0 for an empty file
+} MappedArray;
+
+// Single-producer single-consumer byte ring in shared memory. head and
+// tail only grow, the futex words count publications so that a sleeper
+// can tell whether it missed one.
+typedef struct {
+    _Atomic uint64_t head;             // Bytes written, advanced by the producer
+    char pad0[56];
+    _Atomic uint64_t tail;             // Bytes read, advanced by the consumer
+    char pad1[56];
+    _Atomic uint32_t data_seq;         // Bumped after every write
+    _Atomic uint32_t space_seq;        // Bumped after every read
+    _Atomic uint32_t consumer_waiting;
+    _Atomic uint32_t producer_waiting;
+    char pad2[48];
+    char data[SHM_RING_SIZE];
+} ShmRing;
+
+// A TCP link between two ranks on the same host, upgraded to two rings.
+// rings[0] carries creator -> joiner, rings[1] the other direction. The
+// socket stays open to detect a dead peer.
+typedef struct {
+    ShmRing *tx;
+    ShmRing *rx;
+    void *segment;
+    int sock;
+} ShmChannel;
+
+// Intra-rank thread pool. The calling thread works on tasks too, so a
+// pool of N threads has N - 1 helper threads.
+typedef void (*ParallelTask)(void* arg, int index);
+
+typedef struct {
+    pthread_t *threads;
+    int thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;
+    pthread_cond_t work_done;
+    ParallelTask task;
+    void *task_arg;
+    int task_count;
+    int next_task;
+    int unfinished;
+    bool shutdown;
+} ThreadPool;
+
+// Worker connection whose registration message is still arriving
+typedef struct {
+    char buffer[BUFFER_SIZE];
+    size_t used;
+} PendingRegistration;
+
+// One unit of work for the coordinator: command plus dataset
+typedef struct {
+    char command[MAX_COMMAND_LEN];
+    int array_length;
+} Job;
+
+// ==================== Function Declarations ====================
+
+bool parse_options(int argc, char* argv[], int first, Options* opts);
+
+// Job execution, the communicator is reused for every job
+bool parse_job(const char* line, Job* job);
+bool read_job(Job* job);
+void run_coordinator_job(Communicator* comm, Job* job);
+void run_worker_loop(Communicator* comm);
+
+// Connection setup functions
+CoordinatorResult* setup_coordinator(const char* ip, int port, const Options* opts);
+int read_registration(int sock, PendingRegistration* reg);
+bool register_worker(CoordinatorResult* result, int sock, const char* message);
+bool read_registration_command(CoordinatorResult* result, bool* stdin_open);
+WorkerConnection* connect_to_coordinator(const char* worker_ip, int worker_port,
+                                        const char* coordinator_ip, int coordinator_port);
+void free_coordinator_result(CoordinatorResult* result);
+void free_worker_connection(WorkerConnection* conn);
+int connect_with_retry(const char* ip, int port);
+int open_listener(int port);
+
+// Communicator functions
+Communicator* create_coordinator_communicator(int rank, int* worker_sockets, 
+                                            int worker_count, WorkerInfo* worker_infos,
+                                            bool use_tree);
+Communicator* create_worker_communicator(int rank, int coordinator_socket, int listen_socket,
+                                       const char* right_neighbor_ip, int right_neighbor_port,
+                                       int size, bool use_tree, WorkerInfo* peer_infos);
+void free_communicator(Communicator* comm);
+
+// Communication operations
+void send_int(Communicator* comm, int value, int dest);
+int receive_int(Communicator* comm, int source);
+void send_int64(Communicator* comm, int64_t value, int dest);
+int64_t receive_int64(Communicator* comm, int source);
+void send_int_array(Communicator* comm, int* data, int length, int dest);
+int* receive_int_array(Communicator* comm, int source, int* length);
+int receive_int_array_into(Communicator* comm, int source, int* buffer, int capacity);
+int64_t reduce_int(Communicator* comm, int64_t value, int64_t (*op)(int64_t, int64_t));
+bool reduce_bool(Communicator* comm, bool value);
+void broadcast_string(Communicator* comm, const char* message);
+char* receive_broadcast(Communicator* comm);
+void barrier(Communicator* comm);
+int* scatter(Communicator* comm, int* data, int* chunk_sizes, int* my_chunk_size);
+int** gather(Communicator* comm, int* data, int length, int* lengths);
+int gather_into(Communicator* comm, int* data, int length, int* out, int capacity);
+void broadcast_int_array(Communicator* comm, int* data, int length);
+int* receive_broadcast_int_array(Communicator* comm, int* length);
+void connect_peers(Communicator* comm);
+int* alltoallv(Communicator* comm, int* data, int* send_counts, int* recv_counts);
+
+// Binomial tree collectives (log P depth instead of P sequential star transfers)
+int tree_parent(int rank);
+int tree_subtree_end(int rank, int size);
+int64_t reduce_int_tree(Communicator* comm, int64_t value, int64_t (*op)(int64_t, int64_t));
+void broadcast_string_tree(Communicator* comm, const char* message);
+char* receive_broadcast_tree(Communicator* comm);
+void barrier_tree(Communicator* comm);
+int* scatter_tree(Communicator* comm, int* data, int* chunk_sizes, int* my_chunk_size);
+
+// Ring collectives over the neighbor links, for int64_t vectors
+int ring_reduce_scatter(Communicator* comm, int64_t* data, int count,
+                        int64_t (*op)(int64_t, int64_t), int* offset);
+void ring_allreduce(Communicator* comm, int64_t* data, int count,
+                    int64_t (*op)(int64_t, int64_t));
+
+// Shared-memory transport: send_all/recv_all/send_with_header use the
+// rings transparently once a socket has been upgraded
+void shm_upgrade_links(const int* sockets, const bool* creator, int count);
+void shm_detach(int sock);
+void close_link(int sock);
+
+// Bulk transfer layer: complete transfers despite short reads/writes,
+// header and payload in one sendmsg, MSG_ZEROCOPY for large payloads
+bool send_all(int sock, const void* buffer, size_t length);
+bool recv_all(int sock, void* buffer, size_t length);
+bool send_with_header(int sock, const void* header, size_t header_length,
+                      const void* payload, size_t payload_length);
+void send_array_on_socket(int sock, const int* data, int length);
+int* receive_array_on_socket(int sock, int* length);
+int receive_array_on_socket_into(int sock, int* buffer, int capacity);
+
+// Neighbor communication
+void send_to_left_neighbor(Communicator* comm, int value);
+void send_to_right_neighbor(Communicator* comm, int value);
+int receive_from_left_neighbor(Communicator* comm);
+int receive_from_right_neighbor(Communicator* comm);
+void send_array_to_left_neighbor(Communicator* comm, int* data, int length);
+void send_array_to_right_neighbor(Communicator* comm, int* data, int length);
+int* receive_array_from_left_neighbor(Communicator* comm, int* length);
+int* receive_array_from_right_neighbor(Communicator* comm, int* length);
+int receive_array_from_left_neighbor_into(Communicator* comm, int* buffer, int capacity);
+int receive_array_from_right_neighbor_into(Communicator* comm, int* buffer, int capacity);
+
+// Algorithm functions
+void* sum_algorithm(Communicator* comm, int* local_data, int length);
+void* min_algorithm(Communicator* comm, int* local_data, int length);
+void* max_algorithm(Communicator* comm, int* local_data, int length);
+void* sort_algorithm(Communicator* comm, int* local_data, int length);
+void* samplesort_algorithm(Communicator* comm, int* local_data, int length);
+AlgorithmFunc find_algorithm(const char* command);
+
+// Thread pool and parallel local kernels
+ThreadPool* thread_pool_create(int thread_count);
+void thread_pool_run(ThreadPool* pool, ParallelTask task, void* arg, int task_count);
+void thread_pool_destroy(ThreadPool* pool);
+int parallel_task_count(int length);
+int64_t parallel_sum(const int* data, int length);
+int parallel_min(const int* data, int length);
+int parallel_max(const int* data, int length);
+void parallel_sort(int* data, int length);
+
+// SIMD reduction kernels, picked once at startup by CPU features
+void select_reduction_kernels(void);
+int64_t sum_scalar(const int* data, int length);
+int min_scalar(const int* data, int length);
+int max_scalar(const int* data, int length);
+
+// Memory-mapped datasets
+bool map_input_file(const char* path, MappedArray* map);
+bool map_output_file(const char* path, int length, MappedArray* map);
+void unmap_array(MappedArray* map);
+int* gather_sorted_result(Communicator* comm, int* data, int length);
+
+// Utility functions
+int* create_random_array(int length);
+int* calculate_chunk_sizes(int array_length, int num_processes);
+void quick_sort(int* arr, int length);
+void insert_from_left(int* arr, int length);
+void insert_from_right(int* arr, int length);
+void merge_keep_low(int* arr, int length, const int* other, int other_length, int* scratch);
+void merge_keep_high(int* arr, int length, const int* other, int other_length, int* scratch);
+const char* sort_mode_name(SortMode mode);
+void merge_runs(int* data, int* run_lengths, int run_count, int* out);
+int upper_bound(const int* arr, int low, int high, int value);
+bool validate_sum(int64_t calculated_sum, int* original_array, int length);
+bool validate_min(int calculated_min, int* original_array, int length);
+bool validate_max(int calculated_max, int* original_array, int length);
+bool is_sorted(int* array, int length);
+
+// Helper functions
+int64_t min_op(int64_t a, int64_t b);
+int64_t max_op(int64_t a, int64_t b);
+int64_t sum_op(int64_t a, int64_t b);
+
+#endif
+
+// ==================== parallel_computation.c ===================
+
+// Runtime options, filled once in main()
+static Options options = {
+    .sort_mode = SORT_MODE_BLOCK,
+    .tree_threshold = DEFAULT_TREE_THRESHOLD,
+    .session = false,
+    .threads = 0,
+    .input_path = NULL,
+    .output_path = NULL,
+    .shm = true,
+    .expect = 0,
+    .register_timeout = 0
+};
+
+// Coordinator datasets: the --input mapping lives for the whole run, the
+// --output mapping only while a sort job gathers into it
+static MappedArray input_array = {NULL, 0, 0};
+static MappedArray output_array = {NULL, 0, 0};
+
+// Compute threads of this rank, created once in main()
+static ThreadPool* thread_pool = NULL;
+
+// ==================== Main Program ====================
+
+void print_usage(void) {
+    printf("Usage:\nCoordinator: c <ownIP> <ownPort> [options]\n");
+    printf("Worker: w <ownIP> <ownPort> <coordinatorIP> <coordinatorPort> [options]\n");
+    printf("Options:\n");
+    printf("  --sort-mode block|element  Odd-even sort variant (default: block)\n");
+    printf("  --tree-threshold <P>       Tree collectives from P ranks on (default: %d, 0 = always)\n",
+           DEFAULT_TREE_THRESHOLD);
+    printf("  --session                  Coordinator: keep running jobs '<COMMAND> [length]' until QUIT\n");
+    printf("  --threads <N>              Compute threads per rank (default: number of cores)\n");
+    printf("  --input <file>             Coordinator: use the native int array in <file> (mmap)\n");
+    printf("  --output <file>            Coordinator: write sorted results to <file> (mmap)\n");
+    printf("  --no-shm                   Keep TCP between ranks on the same host\n");
+    printf("  --expect <N>               Coordinator: close registration after N workers\n");
+    printf("  --timeout <s>              Coordinator: close registration after s seconds\n");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        print_usage();
+        return 1;
+    }
+    
+    bool is_coordinator = (argv[1][0] == 'c' || argv[1][0] == 'C');
+    char* own_ip = argv[2];
+    int own_port = atoi(argv[3]);
+    
+    if (!parse_options(argc, argv, is_coordinator ? 4 : 6, &options)) {
+        print_usage();
+        return 1;
+    }
+    
+    int threads = options.threads;
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads <= 0) threads = 1;
+    }
+    thread_pool = thread_pool_create(threads);
+    printf("Using %d compute thread(s)\n", threads);
+    select_reduction_kernels();
+    
+    if (is_coordinator) {
+        // Run as coordinator
+        if (options.input_path) {
+            if (!map_input_file(options.input_path, &input_array)) return 1;
+            printf("[Coordinator] Mapped %d elements from %s\n", input_array.length, options.input_path);
+        }
+        
+        CoordinatorResult* result = setup_coordinator(own_ip, own_port, &options);
+        if (!result) {
+            fprintf(stderr, "Failed to setup coordinator\n");
+            return 1;
+        }
+        
+        // Create communicator
+        Communicator* comm = create_coordinator_communicator(0, result->sockets, 
+                                                           result->worker_count, 
+                                                           result->worker_infos,
+                                                           result->use_tree);
+        
+        // The command that closed registration is the first job. If
+        // --expect or --timeout closed it, the first job comes from stdin.
+        Job job;
+        bool have_job = result->command[0] ? parse_job(result->command, &job)
+                                           : read_job(&job);
+        if (have_job) {
+            run_coordinator_job(comm, &job);
+            
+            // Session mode: keep workers and links for further jobs
+            while (options.session && read_job(&job)) {
+                run_coordinator_job(comm, &job);
+            }
+        }
+        
+        // Cleanup
+        broadcast_string(comm, "QUIT");
+        barrier(comm);
+        printf("[Coordinator] Shutting down...\n");
+        free_communicator(comm);
+        free_coordinator_result(result);
+        unmap_array(&input_array);
+        printf("[Coordinator] Goodbye!\n");
+        
+    } else {
+        // Run as worker
+        if (argc < 6) {
+            printf("Usage for Worker: w <ownIP> <ownPort> <coordinatorIP> <coordinatorPort>\n");
+            return 1;
+        }
+        
+        char* coordinator_ip = argv[4];
+        int coordinator_port = atoi(argv[5]);
+        
+        WorkerConnection* conn = connect_to_coordinator(own_ip, own_port, 
+                                                       coordinator_ip, coordinator_port);
+        if (!conn) {
+            fprintf(stderr, "Failed to connect to coordinator\n");
+            return 1;
+        }
+        
+        // Create communicator
+        Communicator* comm = create_worker_communicator(conn->id, conn->socket,
+                                                       conn->listen_socket,
+                                                       conn->right_neighbor_ip, 
+                                                       conn->right_neighbor_port,
+                                                       conn->size, conn->use_tree,
+                                                       conn->peer_infos);
+        
+        printf("[Worker %d] Ready and waiting for data...\n", comm->rank);
+        
+        // Run jobs until the coordinator sends QUIT
+        run_worker_loop(comm);
+        
+        // Cleanup
+        barrier(comm);
+        printf("[Worker %d] Shutting down...\n", comm->rank);
+        
+        int worker_id = comm->rank;  // NEU: Speichern vor dem Freigeben
+        
+        free_communicator(comm);
+        free_worker_connection(conn);
+        printf("[Worker %d] Worker terminated.\n", worker_id);  // GEÄNDERT: worker_id statt conn->id
+    }
+    
+    thread_pool_destroy(thread_pool);
+    return 0;
+}
+
+// ==================== Jobs ====================
+
+// Job line: <COMMAND> [array length]. Without a length the job uses the
+// whole --input file or DEFAULT_ARRAY_LENGTH random elements (-1 here).
+bool parse_job(const char* line, Job* job) {
+    char command[MAX_COMMAND_LEN];
+    int array_length = -1;
+    
+    int fields = sscanf(line, "%31s %d", command, &array_length);
+    if (fields < 1 || !find_algorithm(command) || (fields == 2 && array_length < 0)) {
+        return false;
+    }
+    
+    strcpy(job->command, command);
+    job->array_length = array_length;
+    return true;
+}
+
+// Prompts until a valid job line arrives. False on QUIT or end of input.
+bool read_job(Job* job) {
+    char line[MAX_COMMAND_LEN];
+    while (true) {
+        printf("Coordinator> ");
+        fflush(stdout);
+        if (!fgets(line, MAX_COMMAND_LEN, stdin)) return false;
+        line[strcspn(line, "\n")] = 0;
+        for (int i = 0; line[i]; i++) {
+            line[i] = toupper(line[i]);
+        }
+        
+        if (line[0] == '\0') continue;
+        if (strcmp(line, "QUIT") == 0) return false;
+        if (parse_job(line, job)) return true;
+        printf("Invalid job. Usage: <SUM|MIN|MAX|SORT|SAMPLESORT> [length] or QUIT\n");
+    }
+}
+
+void run_coordinator_job(Communicator* comm, Job* job) {
+    // Initial array: a prefix of the mapped input file or random data
+    int array_length = job->array_length;
+    int* initial_array;
+    if (options.input_path) {
+        if (array_length < 0 || array_length > input_array.length) {
+            array_length = input_array.length;
+        }
+        initial_array = input_array.data;
+        printf("[Coordinator] Using %d elements of %s\n", array_length, options.input_path);
+    } else {
+        if (array_length < 0) array_length = DEFAULT_ARRAY_LENGTH;
+        initial_array = create_random_array(array_length);
+        printf("[Coordinator] Created initial array of length %d\n", array_length);
+    }
+    
+    // Sorted results are gathered straight into the mapped output file
+    bool is_sort = strcasecmp(job->command, "SORT") == 0 ||
+                   strcasecmp(job->command, "SAMPLESORT") == 0;
+    bool mapped_output = false;
+    if (is_sort && options.output_path) {
+        mapped_output = map_output_file(options.output_path, array_length, &output_array);
+        if (!mapped_output) {
+            fprintf(stderr, "[Coordinator] Falling back to an in-memory result\n");
+        }
+    }
+    
+    // Broadcast command, then distribute array
+    printf("[Coordinator] Executing command: %s\n", job->command);
+    broadcast_string(comm, job->command);
+    
+    int* chunk_sizes = calculate_chunk_sizes(array_length, comm->size);
+    int my_chunk_size;
+    int* chunk = scatter(comm, initial_array, chunk_sizes, &my_chunk_size);
+    
+    printf("[Coordinator] Array distributed. My chunk: [");
+    for (int i = 0; i < my_chunk_size; i++) {
+        printf("%d%s", chunk[i], (i < my_chunk_size - 1) ? ", " : "");
+    }
+    printf("]\n");
+    
+    // Execute algorithm
+    AlgorithmFunc algorithm = find_algorithm(job->command);
+    void* result_value = algorithm(comm, chunk, my_chunk_size);
+    
+    // Display results
+    if (result_value) {
+        if (strcasecmp(job->command, "SUM") == 0) {
+            int64_t sum = *(int64_t*)result_value;
+            printf("[Coordinator] Final Sum: %" PRId64 "\n", sum);
+            printf("[Coordinator] Correct? %s\n", 
+                   validate_sum(sum, initial_array, array_length) ? "true" : "false");
+        } else if (strcasecmp(job->command, "MIN") == 0) {
+            int min = *(int*)result_value;
+            printf("[Coordinator] Final Min: %d\n", min);
+            printf("[Coordinator] Correct? %s\n", 
+                   validate_min(min, initial_array, array_length) ? "true" : "false");
+        } else if (strcasecmp(job->command, "MAX") == 0) {
+            int max = *(int*)result_value;
+            printf("[Coordinator] Final Max: %d\n", max);
+            printf("[Coordinator] Correct? %s\n", 
+                   validate_max(max, initial_array, array_length) ? "true" : "false");
+        } else if (strcasecmp(job->command, "SORT") == 0 ||
+                   strcasecmp(job->command, "SAMPLESORT") == 0) {
+            int* sorted = (int*)result_value;
+            printf("[Coordinator] Final sorted array: [");
+            for (int i = 0; i < array_length; i++) {
+                printf("%d%s", sorted[i], (i < array_length - 1) ? ", " : "");
+            }
+            printf("]\n");
+            printf("[Coordinator] Correctly sorted? %s\n", 
+                   is_sorted(sorted, array_length) ? "true" : "false");
+        }
+        if (result_value != output_array.data) free(result_value);
+    }
+    
+    if (mapped_output) {
+        printf("[Coordinator] Sorted result written to %s\n", options.output_path);
+        unmap_array(&output_array);
+    }
+    
+    free(chunk);
+    free(chunk_sizes);
+    if (initial_array != input_array.data) free(initial_array);
+}
+
+void run_worker_loop(Communicator* comm) {
+    while (true) {
+        // Receive command
+        char* command = receive_broadcast(comm);
+        printf("[Worker %d] Received command: %s\n", comm->rank, command);
+        if (strcmp(command, "QUIT") == 0) {
+            free(command);
+            break;
+        }
+        
+        // Receive array chunk
+        int chunk_length;
+        int* chunk = scatter(comm, NULL, NULL, &chunk_length);
+        printf("[Worker %d] Received chunk: [", comm->rank);
+        for (int i = 0; i < chunk_length; i++) {
+            printf("%d%s", chunk[i], (i < chunk_length - 1) ? ", " : "");
+        }
+        printf("]\n");
+        
+        // Execute algorithm
+        AlgorithmFunc algorithm = find_algorithm(command);
+        if (algorithm) {
+            algorithm(comm, chunk, chunk_length);
+        }
+        
+        free(chunk);
+        free(command);
+    }
+}
+
+AlgorithmFunc find_algorithm(const char* command) {
+    if (strcasecmp(command, "SUM") == 0) return sum_algorithm;
+    if (strcasecmp(command, "MIN") == 0) return min_algorithm;
+    if (strcasecmp(command, "MAX") == 0) return max_algorithm;
+    if (strcasecmp(command, "SORT") == 0) return sort_algorithm;
+    if (strcasecmp(command, "SAMPLESORT") == 0) return samplesort_algorithm;
+    return NULL;
+}
+
+bool parse_options(int argc, char* argv[], int first, Options* opts) {
+    for (int i = first; i < argc; i++) {
+        if (strcmp(argv[i], "--sort-mode") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcasecmp(mode, "block") == 0) {
+                opts->sort_mode = SORT_MODE_BLOCK;
+            } else if (strcasecmp(mode, "element") == 0) {
+                opts->sort_mode = SORT_MODE_ELEMENT;
+            } else {
+                fprintf(stderr, "Unknown sort mode: %s\n", mode);
+                return false;
+            }
+        } else if (strcmp(argv[i], "--tree-threshold") == 0 && i + 1 < argc) {
+            opts->tree_threshold = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--session") == 0) {
+            opts->session = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            opts->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            opts->input_path = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            opts->output_path = argv[++i];
+        } else if (strcmp(argv[i], "--no-shm") == 0) {
+            opts->shm = false;
+        } else if (strcmp(argv[i], "--expect") == 0 && i + 1 < argc) {
+            opts->expect = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            opts->register_timeout = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ==================== Connection Setup Implementation ====================
+
+CoordinatorResult* setup_coordinator(const char* ip, int port, const Options* opts) {
+    int server_socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (server_socket < 0) {
+        perror("Socket creation failed");
+        return NULL;
+    }
+    
+    // Allow socket reuse
+    int opt = 1;
+    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    
+    struct sockaddr_in server_addr;
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+    server_addr.sin_port = htons(port);
+    
+    if (bind(server_socket, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        perror("Bind failed");
+        close(server_socket);
+        return NULL;
+    }
+    
+    if (listen(server_socket, SOMAXCONN) < 0) {
+        perror("Listen failed");
+        close(server_socket);
+        return NULL;
+    }
+    
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd < 0) {
+        perror("epoll_create1 failed");
+        close(server_socket);
+        return NULL;
+    }
+    struct epoll_event ev = { .events = EPOLLIN, .data.fd = server_socket };
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_socket, &ev);
+    
+    // stdin unbuffered, so that epoll readiness matches what fgets has
+    // not consumed yet. A regular file cannot be polled and is read at once.
+    setvbuf(stdin, NULL, _IONBF, 0);
+    ev.data.fd = STDIN_FILENO;
+    bool stdin_open = true;
+    bool stdin_polled = epoll_ctl(epoll_fd, EPOLL_CTL_ADD, STDIN_FILENO, &ev) == 0;
+    
+    printf("[Coordinator] Server started on %s:%d\n", ip, port);
+    printf("[Coordinator] Waiting for workers...\n\n");
+    printf("=== Available Commands ===\n");
+    printf("  SUM  - Calculate sum of array\n");
+    printf("  MIN  - Find minimum of array\n");
+    printf("  MAX  - Find maximum of array\n");
+    printf("  SORT - Sort array using odd-even transposition\n");
+    printf("  SAMPLESORT - Sort array using parallel sample sort (PSRS)\n");
+    printf("===========================\n");
+    printf("Optional array length after the command, e.g. SORT 1000 (default: %d)\n", DEFAULT_ARRAY_LENGTH);
+    if (opts->expect > 0) {
+        printf("Registration closes after %d workers or with the first command:\n", opts->expect);
+    } else {
+        printf("Enter command when all workers are connected:\n");
+    }
+    printf("Coordinator> ");
+    fflush(stdout);
+    
+    CoordinatorResult* result = malloc(sizeof(CoordinatorResult));
+    int capacity = 64;
+    result->sockets = malloc(capacity * sizeof(int));
+    result->worker_infos = malloc(capacity * sizeof(WorkerInfo));
+    result->worker_count = 0;
+    result->command[0] = '\0';
+    
+    // Registrations still being read, indexed by socket
+    PendingRegistration** pending = NULL;
+    int pending_capacity = 0;
+    
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    struct epoll_event events[64];
+    bool registration_open = true;
+    while (registration_open) {
+        if (opts->expect > 0 && result->worker_count >= opts->expect) {
+            printf("[Coordinator] All %d expected workers registered\n", opts->expect);
+            break;
+        }
+        if (stdin_open && !stdin_polled) {
+            registration_open = !read_registration_command(result, &stdin_open);
+            continue;
+        }
+        
+        int timeout_ms = -1;
+        if (opts->register_timeout > 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long elapsed = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+            timeout_ms = (int)(opts->register_timeout * 1000L - elapsed);
+            if (timeout_ms <= 0) {
+                printf("[Coordinator] Registration timeout after %d s\n", opts->register_timeout);
+                break;
+            }
+        }
+        if (!stdin_open && opts->expect <= 0 && opts->register_timeout <= 0) {
+            printf("[Coordinator] stdin closed, stopping worker registration\n");
+            break;
+        }
+        
+        int ready = epoll_wait(epoll_fd, events, 64, timeout_ms);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait failed");
+            break;
+        }
+        
+        for (int e = 0; e < ready && registration_open; e++) {
+            int fd = events[e].data.fd;
+            
+            if (fd == server_socket) {
+                // Drain the backlog, connects arrive in bursts
+                int worker_socket;
+                while ((worker_socket = accept(server_socket, NULL, NULL)) >= 0) {
+                    fcntl(worker_socket, F_SETFL, fcntl(worker_socket, F_GETFL) | O_NONBLOCK);
+                    if (worker_socket >= pending_capacity) {
+                        int new_capacity = (worker_socket + 1 > 2 * pending_capacity) 
+                                           ? worker_socket + 1 : 2 * pending_capacity;
+                        pending = realloc(pending, new_capacity * sizeof(PendingRegistration*));
+                        for (int i = pending_capacity; i < new_capacity; i++) pending[i] = NULL;
+                        pending_capacity = new_capacity;
+                    }
+                    pending[worker_socket] = calloc(1, sizeof(PendingRegistration));
+                    struct epoll_event worker_ev = { .events = EPOLLIN, .data.fd = worker_socket };
+                    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, worker_socket, &worker_ev);
+                }
+            } else if (fd == STDIN_FILENO) {
+                if (read_registration_command(result, &stdin_open)) {
+                    registration_open = false;
+                } else if (!stdin_open) {
+                    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, STDIN_FILENO, NULL);
+                }
+            } else {
+                PendingRegistration* reg = pending[fd];
+                int status = read_registration(fd, reg);
+                if (status == 0) continue;
+                
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+                pending[fd] = NULL;
+                if (status < 0) {
+                    close(fd);
+                } else {
+                    if (result->worker_count == capacity) {
+                        capacity *= 2;
+                        result->sockets = realloc(result->sockets, capacity * sizeof(int));
+                        result->worker_infos = realloc(result->worker_infos, 
+                                                       capacity * sizeof(WorkerInfo));
+                    }
+                    register_worker(result, fd, reg->buffer);
+                }
+                free(reg);
+            }
+        }
+    }
+    
+    // Connections that never finished their registration are dropped
+    for (int fd = 0; fd < pending_capacity; fd++) {
+        if (pending[fd]) {
+            close(fd);
+            free(pending[fd]);
+        }
+    }
+    free(pending);
+    close(epoll_fd);
+    
+    // Send neighbor information
+    for (int i = 0; i < result->worker_count; i++) {
+        bool has_right = (i < result->worker_count - 1);
+        send(result->sockets[i], &has_right, sizeof(bool), 0);
+        
+        if (has_right) {
+            send(result->sockets[i], result->worker_infos[i + 1].ip, INET_ADDRSTRLEN, 0);
+            send(result->sockets[i], &result->worker_infos[i + 1].port, sizeof(int), 0);
+        }
+    }
+    
+    // Send job size, collective mode and the address table of all workers
+    int size = result->worker_count + 1;
+    result->use_tree = (size >= opts->tree_threshold);
+    for (int i = 0; i < result->worker_count; i++) {
+        send(result->sockets[i], &size, sizeof(int), 0);
+        send(result->sockets[i], &result->use_tree, sizeof(bool), 0);
+        send_all(result->sockets[i], result->worker_infos, 
+                 result->worker_count * sizeof(WorkerInfo));
+    }
+    
+    close(server_socket);
+    printf("[Coordinator] Network setup complete with %d workers.\n", result->worker_count);
+    printf("[Coordinator] Collectives: %s\n", result->use_tree ? "binomial tree" : "star");
+    if (result->command[0]) {
+        printf("[Coordinator] Will execute command: %s\n", result->command);
+    }
+    
+    return result;
+}
+
+// Reads what has arrived of a "REGISTRATION:<ip>:<port>\0" message.
+// Returns 1 once it is complete, 0 if more is needed, -1 on error.
+int read_registration(int sock, PendingRegistration* reg) {
+    while (true) {
+        ssize_t received = recv(sock, reg->buffer + reg->used, BUFFER_SIZE - reg->used, 0);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (received == 0) return -1;
+        
+        reg->used += received;
+        if (memchr(reg->buffer, '\0', reg->used)) return 1;
+        if (reg->used == BUFFER_SIZE) return -1;
+    }
+}
+
+// Adds a completely registered worker and sends it its ID. The socket
+// goes back to blocking mode for everything that follows.
+bool register_worker(CoordinatorResult* result, int sock, const char* message) {
+    char worker_ip[INET_ADDRSTRLEN];
+    int worker_port;
+    if (strncmp(message, "REGISTRATION:", 13) != 0 ||
+        sscanf(message + 13, "%15[^:]:%d", worker_ip, &worker_port) != 2) {
+        close(sock);
+        return false;
+    }
+    
+    int flags = fcntl(sock, F_GETFL);
+    fcntl(sock, F_SETFL, flags & ~O_NONBLOCK);
+    
+    int current_id = result->worker_count + 1;
+    result->sockets[result->worker_count] = sock;
+    strcpy(result->worker_infos[result->worker_count].ip, worker_ip);
+    result->worker_infos[result->worker_count].port = worker_port;
+    result->worker_infos[result->worker_count].id = current_id;
+    
+    printf("[Coordinator] Worker %d registered from %s:%d\n", 
+           current_id, worker_ip, worker_port);
+    
+    // Send ID to worker
+    send_all(sock, &current_id, sizeof(int));
+    
+    result->worker_count++;
+    printf("[Coordinator] Total workers connected: %d\n", result->worker_count);
+    return true;
+}
+
+// One line from stdin during registration. Returns true once a valid job
+// has been entered, which closes the registration.
+bool read_registration_command(CoordinatorResult* result, bool* stdin_open) {
+    char input[MAX_COMMAND_LEN];
+    if (!fgets(input, MAX_COMMAND_LEN, stdin)) {
+        *stdin_open = false;
+        return false;
+    }
+    input[strcspn(input, "\n")] = 0; // Remove newline
+    
+    // Convert to uppercase
+    for (int i = 0; input[i]; i++) {
+        input[i] = toupper(input[i]);
+    }
+    
+    Job job;
+    if (parse_job(input, &job)) {
+        strcpy(result->command, input);
+        printf("[Coordinator] Command '%s' received. Stopping worker registration...\n", input);
+        return true;
+    }
+    
+    if (input[0]) {
+        printf("Invalid command. Available: SUM, MIN, MAX, SORT, SAMPLESORT [length]\n");
+    }
+    printf("Coordinator> ");
+    fflush(stdout);
+    return false;
+}
+
+WorkerConnection* connect_to_coordinator(const char* worker_ip, int worker_port,
+                                       const char* coordinator_ip, int coordinator_port) {
+    // Listen before registering: once the coordinator publishes the
+    // address table, every rank can connect to us without waiting
+    int listen_socket = open_listener(worker_port);
+    if (listen_socket < 0) return NULL;
+    
+    printf("[Worker] Connecting to coordinator at %s:%d...\n", coordinator_ip, coordinator_port);
+    int sock = connect_with_retry(coordinator_ip, coordinator_port);
+    if (sock < 0) {
+        close(listen_socket);
+        return NULL;
+    }
+    
+    // Send registration
+    char registration[BUFFER_SIZE];
+    snprintf(registration, BUFFER_SIZE, "REGISTRATION:%s:%d", worker_ip, worker_port);
+    send(sock, registration, strlen(registration) + 1, 0);
+    
+    // Receive ID
+    int worker_id;
+    recv(sock, &worker_id, sizeof(int), 0);
+    
+    // Receive neighbor info
+    bool has_right_neighbor;
+    recv(sock, &has_right_neighbor, sizeof(bool), 0);
+    
+    WorkerConnection* conn = malloc(sizeof(WorkerConnection));
+    conn->socket = sock;
+    conn->listen_socket = listen_socket;
+    conn->id = worker_id;
+    strcpy(conn->own_ip, worker_ip);
+    conn->own_port = worker_port;
+    conn->has_right_neighbor = has_right_neighbor;
+    
+    if (has_right_neighbor) {
+        recv(sock, conn->right_neighbor_ip, INET_ADDRSTRLEN, 0);
+        recv(sock, &conn->right_neighbor_port, sizeof(int), 0);
+        printf("[Worker] Successfully connected with ID: %d\n", worker_id);
+        printf("[Worker] Right neighbor at: %s:%d\n", 
+               conn->right_neighbor_ip, conn->right_neighbor_port);
+    } else {
+        conn->right_neighbor_port = -1;
+        printf("[Worker] Successfully connected with ID: %d\n", worker_id);
+        printf("[Worker] No right neighbor (last worker)\n");
+    }
+    
+    // Receive job size and collective mode
+    recv(sock, &conn->size, sizeof(int), MSG_WAITALL);
+    recv(sock, &conn->use_tree, sizeof(bool), MSG_WAITALL);
+    conn->peer_infos = malloc((conn->size - 1) * sizeof(WorkerInfo));
+    recv_all(sock, conn->peer_infos, (conn->size - 1) * sizeof(WorkerInfo));
+    
+    return conn;
+}
+
+// The peer may not be listening yet when the neighbor info arrives,
+// so retry for a few seconds before giving up on the link.
+int connect_with_retry(const char* ip, int port) {
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, ip, &addr.sin_addr);
+    
+    for (int attempt = 0; attempt < 100; attempt++) {
+        int sock = socket(AF_INET, SOCK_STREAM, 0);
+        if (sock < 0) return -1;
+        if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            return sock;
+        }
+        close(sock);
+        usleep(50000);
+    }
+    
+    fprintf(stderr, "Could not connect to %s:%d\n", ip, port);
+    return -1;
+}
+
+// Listening socket for the left neighbor, tree children and peer links
+int open_listener(int port) {
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) {
+        perror("Socket creation failed");
+        return -1;
+    }
+    
+    int opt = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    
+    if (bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+        listen(sock, SOMAXCONN) < 0) {
+        perror("Listen failed");
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// ==================== Communicator Implementation ====================
+
+Communicator* create_coordinator_communicator(int rank, int* worker_sockets, 
+                                            int worker_count, WorkerInfo* worker_infos,
+                                            bool use_tree) {
+    Communicator* comm = malloc(sizeof(Communicator));
+    comm->rank = 0;
+    comm->is_root = true;
+    comm->size = worker_count + 1;
+    
+    // Star topology
+    comm->connection_count = worker_count;
+    comm->connections = malloc(worker_count * sizeof(int));
+    memcpy(comm->connections, worker_sockets, worker_count * sizeof(int));
+    
+    // Ring topology - connect to first worker if exists
+    comm->left_neighbor_socket = -1;
+    comm->has_left_neighbor = false;
+    comm->right_neighbor_socket = -1;
+    comm->has_right_neighbor = false;
+    
+    if (worker_count > 0) {
+        int sock = connect_with_retry(worker_infos[0].ip, worker_infos[0].port);
+        if (sock >= 0) {
+            send_all(sock, &comm->rank, sizeof(int));
+            comm->right_neighbor_socket = sock;
+            comm->has_right_neighbor = true;
+            printf("[Coordinator] Connected to right neighbor (Worker 1)\n");
+        }
+    }
+    
+    // Tree topology - children 1, 2, 4, ... are reached over the star links
+    comm->use_tree = use_tree;
+    comm->tree_parent_socket = -1;
+    comm->tree_child_count = 0;
+    comm->tree_child_sockets = malloc(32 * sizeof(int));
+    comm->tree_child_ranks = malloc(32 * sizeof(int));
+    for (int step = 1; step < comm->size; step <<= 1) {
+        comm->tree_child_sockets[comm->tree_child_count] = comm->connections[step - 1];
+        comm->tree_child_ranks[comm->tree_child_count] = step;
+        comm->tree_child_count++;
+    }
+    
+    comm->peer_infos = malloc((worker_count > 0 ? worker_count : 1) * sizeof(WorkerInfo));
+    memcpy(comm->peer_infos, worker_infos, worker_count * sizeof(WorkerInfo));
+    comm->listen_socket = -1;
+    comm->peer_sockets = NULL;
+    
+    comm->ring_next_socket = comm->right_neighbor_socket;
+    comm->ring_prev_socket = (worker_count > 0) ? comm->connections[worker_count - 1] : -1;
+    
+    // The coordinator creates the shared memory of all its links
+    int* links = malloc((worker_count + 1) * sizeof(int));
+    bool* creator = malloc((worker_count + 1) * sizeof(bool));
+    int link_count = 0;
+    for (int i = 0; i < worker_count; i++) {
+        links[link_count] = comm->connections[i];
+        creator[link_count++] = true;
+    }
+    if (comm->has_right_neighbor) {
+        links[link_count] = comm->right_neighbor_socket;
+        creator[link_count++] = true;
+    }
+    shm_upgrade_links(links, creator, link_count);
+    free(links);
+    free(creator);
+    
+    return comm;
+}
+
+Communicator* create_worker_communicator(int rank, int coordinator_socket, int listen_socket,
+                                       const char* right_neighbor_ip, int right_neighbor_port,
+                                       int size, bool use_tree, WorkerInfo* peer_infos) {
+    Communicator* comm = malloc(sizeof(Communicator));
+    comm->rank = rank;
+    comm->is_root = false;
+    comm->size = size;
+    
+    // Star topology - connection to coordinator
+    comm->connection_count = 1;
+    comm->connections = malloc(sizeof(int));
+    comm->connections[0] = coordinator_socket;
+    
+    // Ring topology
+    comm->left_neighbor_socket = -1;
+    comm->has_left_neighbor = false;
+    comm->right_neighbor_socket = -1;
+    comm->has_right_neighbor = false;
+    
+    // Tree topology
+    comm->use_tree = use_tree;
+    comm->tree_parent_socket = -1;
+    comm->tree_child_count = 0;
+    comm->tree_child_sockets = malloc(32 * sizeof(int));
+    comm->tree_child_ranks = malloc(32 * sizeof(int));
+    
+    // All listeners were open before the address table went out, so the
+    // outgoing links are connected first and never wait for an accept.
+    // Every rank does this at the same time; there is no chain along the ring.
+    if (right_neighbor_port > 0) {
+        int sock = connect_with_retry(right_neighbor_ip, right_neighbor_port);
+        if (sock >= 0) {
+            send_all(sock, &rank, sizeof(int));
+            comm->right_neighbor_socket = sock;
+            comm->has_right_neighbor = true;
+        }
+    }
+    
+    int expected_children = 0;
+    if (use_tree) {
+        int parent = tree_parent(rank);
+        if (parent > 0) {
+            comm->tree_parent_socket = connect_with_retry(peer_infos[parent - 1].ip, 
+                                                          peer_infos[parent - 1].port);
+            send_all(comm->tree_parent_socket, &rank, sizeof(int));
+        } else {
+            comm->tree_parent_socket = coordinator_socket;
+        }
+        
+        for (int step = 1; step < (rank & -rank) && rank + step < size; step <<= 1) {
+            comm->tree_child_ranks[expected_children++] = rank + step;
+        }
+    }
+    
+    // Incoming links identify themselves by rank: the left neighbor (the
+    // coordinator for worker 1) is rank - 1, tree children are above us
+    int expected = 1 + expected_children;
+    for (int i = 0; i < expected; i++) {
+        int sock = accept(listen_socket, NULL, NULL);
+        int peer;
+        recv_all(sock, &peer, sizeof(int));
+        
+        if (peer == rank - 1) {
+            comm->left_neighbor_socket = sock;
+            comm->has_left_neighbor = true;
+        } else {
+            // Keep children ordered by rank, smallest subtree first
+            int index = 0;
+            while (comm->tree_child_ranks[index] != peer) index++;
+            comm->tree_child_sockets[index] = sock;
+        }
+    }
+    comm->tree_child_count = expected_children;
+    
+    printf("[Worker %d] Ring links ready (left %s, right %s)\n", rank,
+           comm->has_left_neighbor ? "yes" : "no", comm->has_right_neighbor ? "yes" : "no");
+    if (use_tree) {
+        printf("[Worker %d] Tree links ready (parent %d, %d children)\n", 
+               rank, tree_parent(rank), expected_children);
+    }
+    
+    // Peer links for the all-to-all exchange are opened on first use
+    comm->peer_infos = malloc((size - 1) * sizeof(WorkerInfo));
+    memcpy(comm->peer_infos, peer_infos, (size - 1) * sizeof(WorkerInfo));
+    comm->listen_socket = listen_socket;
+    comm->peer_sockets = NULL;
+    
+    comm->ring_next_socket = comm->has_right_neighbor ? comm->right_neighbor_socket
+                                                      : coordinator_socket;
+    comm->ring_prev_socket = comm->left_neighbor_socket;
+    
+    // The side that connected (or the coordinator, or the tree parent)
+    // creates the shared memory of a link
+    int links[36];
+    bool creator[36];
+    int link_count = 0;
+    links[link_count] = coordinator_socket;
+    creator[link_count++] = false;
+    if (comm->has_left_neighbor) {
+        links[link_count] = comm->left_neighbor_socket;
+        creator[link_count++] = false;
+    }
+    if (comm->has_right_neighbor) {
+        links[link_count] = comm->right_neighbor_socket;
+        creator[link_count++] = true;
+    }
+    if (use_tree && tree_parent(rank) > 0) {
+        links[link_count] = comm->tree_parent_socket;
+        creator[link_count++] = false;
+    }
+    for (int i = 0; i < comm->tree_child_count; i++) {
+        links[link_count] = comm->tree_child_sockets[i];
+        creator[link_count++] = true;
+    }
+    shm_upgrade_links(links, creator, link_count);
+    
+    return comm;
+}
+
+void free_communicator(Communicator* comm) {
+    if (comm->connections) {
+        for (int i = 0; i < comm->connection_count; i++) {
+            close_link(comm->connections[i]);
+        }
+        free(comm->connections);
+    }
+    
+    if (comm->left_neighbor_socket >= 0) close_link(comm->left_neighbor_socket);
+    if (comm->right_neighbor_socket >= 0) close_link(comm->right_neighbor_socket);
+    
+    // Tree links of the coordinator are star sockets, already closed above
+    if (!comm->is_root) {
+        for (int i = 0; i < comm->tree_child_count; i++) {
+            close_link(comm->tree_child_sockets[i]);
+        }
+        if (comm->tree_parent_socket >= 0 && tree_parent(comm->rank) > 0) {
+            close_link(comm->tree_parent_socket);
+        }
+    }
+    free(comm->tree_child_sockets);
+    free(comm->tree_child_ranks);
+    
+    // Peer links to rank 0 and from the coordinator are star sockets
+    if (comm->peer_sockets && !comm->is_root) {
+        for (int i = 1; i < comm->size; i++) {
+            if (comm->peer_sockets[i] >= 0) close_link(comm->peer_sockets[i]);
+        }
+    }
+    free(comm->peer_sockets);
+    free(comm->peer_infos);
+    if (comm->listen_socket >= 0) close(comm->listen_socket);
+    
+    free(comm);
+}
+
+// ==================== Communication Operations ====================
+
+void send_int(Communicator* comm, int value, int dest) {
+    int sock = -1;
+    
+    if (comm->is_root && dest > 0 && dest <= comm->connection_count) {
+        sock = comm->connections[dest - 1];
+    } else if (!comm->is_root && dest == 0) {
+        sock = comm->connections[0];
+    }
+    
+    if (sock >= 0) {
+        send_all(sock, &value, sizeof(int));
+    }
+}
+
+int receive_int(Communicator* comm, int source) {
+    int sock = -1;
+    
+    if (comm->is_root && source > 0 && source <= comm->connection_count) {
+        sock = comm->connections[source - 1];
+    } else if (!comm->is_root && source == 0) {
+        sock = comm->connections[0];
+    }
+    
+    int value = 0;
+    if (sock >= 0) {
+        recv_all(sock, &value, sizeof(int));
+    }
+    
+    return value;
+}
+
+void send_int64(Communicator* comm, int64_t value, int dest) {
+    int sock = -1;
+    
+    if (comm->is_root && dest > 0 && dest <= comm->connection_count) {
+        sock = comm->connections[dest - 1];
+    } else if (!comm->is_root && dest == 0) {
+        sock = comm->connections[0];
+    }
+    
+    if (sock >= 0) {
+        send_all(sock, &value, sizeof(int64_t));
+    }
+}
+
+int64_t receive_int64(Communicator* comm, int source) {
+    int sock = -1;
+    
+    if (comm->is_root && source > 0 && source <= comm->connection_count) {
+        sock = comm->connections[source - 1];
+    } else if (!comm->is_root && source == 0) {
+        sock = comm->connections[0];
+    }
+    
+    int64_t value = 0;
+    if (sock >= 0) {
+        recv_all(sock, &value, sizeof(int64_t));
+    }
+    
+    return value;
+}
+
+void send_int_array(Communicator* comm, int* data, int length, int dest) {
+    int sock = -1;
+    
+    if (comm->is_root && dest > 0 && dest <= comm->connection_count) {
+        sock = comm->connections[dest - 1];
+    } else if (!comm->is_root && dest == 0) {
+        sock = comm->connections[0];
+    }
+    
+    if (sock >= 0) {
+        send_array_on_socket(sock, data, length);
+    }
+}
+
+int* receive_int_array(Communicator* comm, int source, int* length) {
+    int sock = -1;
+    
+    if (comm->is_root && source > 0 && source <= comm->connection_count) {
+        sock = comm->connections[source - 1];
+    } else if (!comm->is_root && source == 0) {
+        sock = comm->connections[0];
+    }
+    
+    if (sock >= 0) {
+        return receive_array_on_socket(sock, length);
+    }
+    
+    *length = 0;
+    return NULL;
+}
+
+// Receives into the caller's buffer, returns the length or -1
+int receive_int_array_into(Communicator* comm, int source, int* buffer, int capacity) {
+    int sock = -1;
+    
+    if (comm->is_root && source > 0 && source <= comm->connection_count) {
+        sock = comm->connections[source - 1];
+    } else if (!comm->is_root && source == 0) {
+        sock = comm->connections[0];
+    }
+    
+    if (sock < 0) return -1;
+    return receive_array_on_socket_into(sock, buffer, capacity);
+}
+
+// Reduction values travel as int64_t so that sums of large arrays stay exact
+int64_t reduce_int(Communicator* comm, int64_t value, int64_t (*op)(int64_t, int64_t)) {
+    if (comm->use_tree) return reduce_int_tree(comm, value, op);
+    
+    if (comm->is_root) {
+        int64_t result = value;
+        for (int i = 1; i < comm->size; i++) {
+            int64_t worker_value = receive_int64(comm, i);
+            result = op(result, worker_value);
+        }
+        return result;
+    } else {
+        send_int64(comm, value, 0);
+        return value;
+    }
+}
+
+bool reduce_bool(Communicator* comm, bool value) {
+    int64_t result = reduce_int(comm, value ? 1 : 0, max_op);
+    return result != 0;
+}
+
+void broadcast_string(Communicator* comm, const char* message) {
+    if (!comm->is_root) return;
+    if (comm->use_tree) {
+        broadcast_string_tree(comm, message);
+        return;
+    }
+    
+    int len = strlen(message) + 1;
+    for (int i = 0; i < comm->connection_count; i++) {
+        send_with_header(comm->connections[i], &len, sizeof(int), message, len);
+    }
+}
+
+char* receive_broadcast(Communicator* comm) {
+    if (comm->is_root) return NULL;
+    if (comm->use_tree) return receive_broadcast_tree(comm);
+    
+    int len;
+    recv_all(comm->connections[0], &len, sizeof(int));
+    
+    char* message = malloc(len);
+    recv_all(comm->connections[0], message, len);
+    
+    return message;
+}
+
+void barrier(Communicator* comm) {
+    if (comm->use_tree) {
+        barrier_tree(comm);
+        return;
+    }
+    
+    if (comm->is_root) {
+        // Receive from all workers
+        for (int i = 1; i < comm->size; i++) {
+            receive_int(comm, i);
+        }
+        // Send acknowledgment to all
+        for (int i = 1; i < comm->size; i++) {
+            send_int(comm, 1, i);
+        }
+    } else {
+        send_int(comm, 1, 0);
+        receive_int(comm, 0);
+    }
+}
+
+int* scatter(Communicator* comm, int* data, int* chunk_sizes, int* my_chunk_size) {
+    if (comm->use_tree) return scatter_tree(comm, data, chunk_sizes, my_chunk_size);
+    
+    if (comm->is_root) {
+        int index = chunk_sizes[0];
+        
+        // Send chunks to workers
+        for (int i = 1; i < comm->size; i++) {
+            send_int_array(comm, &data[index], chunk_sizes[i], i);
+            index += chunk_sizes[i];
+        }
+        
+        // Return coordinator's chunk
+        *my_chunk_size = chunk_sizes[0];
+        int* my_chunk = malloc(chunk_sizes[0] * sizeof(int));
+        memcpy(my_chunk, data, chunk_sizes[0] * sizeof(int));
+        return my_chunk;
+    } else {
+        return receive_int_array(comm, 0, my_chunk_size);
+    }
+}
+
+// lengths (root only, may be NULL) receives the chunk length of every rank
+int** gather(Communicator* comm, int* data, int length, int* lengths) {
+    if (comm->is_root) {
+        int** all_data = malloc(comm->size * sizeof(int*));
+        
+        // Store coordinator's data
+        all_data[0] = malloc(length * sizeof(int));
+        memcpy(all_data[0], data, length * sizeof(int));
+        if (lengths) lengths[0] = length;
+        
+        // Receive from workers
+        for (int i = 1; i < comm->size; i++) {
+            int worker_length;
+            all_data[i] = receive_int_array(comm, i, &worker_length);
+            if (lengths) lengths[i] = worker_length;
+        }
+        
+        return all_data;
+    } else {
+        send_int_array(comm, data, length, 0);
+        return NULL;
+    }
+}
+
+// Like gather, but the root receives every rank's array in rank order
+// directly into out, without per-rank buffers. Returns the element count.
+int gather_into(Communicator* comm, int* data, int length, int* out, int capacity) {
+    if (comm->is_root) {
+        if (length > capacity) length = capacity;
+        memcpy(out, data, length * sizeof(int));
+        int index = length;
+        
+        for (int i = 1; i < comm->size; i++) {
+            int received = receive_int_array_into(comm, i, &out[index], capacity - index);
+            if (received > 0) index += received;
+        }
+        return index;
+    } else {
+        send_int_array(comm, data, length, 0);
+        return length;
+    }
+}
+
+void broadcast_int_array(Communicator* comm, int* data, int length) {
+    if (!comm->is_root) return;
+    
+    if (comm->use_tree) {
+        for (int i = comm->tree_child_count - 1; i >= 0; i--) {
+            send_array_on_socket(comm->tree_child_sockets[i], data, length);
+        }
+        return;
+    }
+    for (int i = 0; i < comm->connection_count; i++) {
+        send_array_on_socket(comm->connections[i], data, length);
+    }
+}
+
+int* receive_broadcast_int_array(Communicator* comm, int* length) {
+    if (comm->is_root) return NULL;
+    
+    if (comm->use_tree) {
+        int* data = receive_array_on_socket(comm->tree_parent_socket, length);
+        for (int i = comm->tree_child_count - 1; i >= 0; i--) {
+            send_array_on_socket(comm->tree_child_sockets[i], data, *length);
+        }
+        return data;
+    }
+    return receive_array_on_socket(comm->connections[0], length);
+}
+
+// ==================== All-to-All Exchange ====================
+
+// Collective: every worker connects to all higher workers and accepts the
+// lower ones on its listening socket. Links to rank 0 reuse the star sockets.
+void connect_peers(Communicator* comm) {
+    if (comm->peer_sockets) return;
+    
+    comm->peer_sockets = malloc(comm->size * sizeof(int));
+    for (int i = 0; i < comm->size; i++) {
+        comm->peer_sockets[i] = -1;
+    }
+    
+    if (comm->is_root) {
+        for (int i = 1; i < comm->size; i++) {
+            comm->peer_sockets[i] = comm->connections[i - 1];
+        }
+        return;
+    }
+    
+    comm->peer_sockets[0] = comm->connections[0];
+    for (int peer = comm->rank + 1; peer < comm->size; peer++) {
+        int sock = connect_with_retry(comm->peer_infos[peer - 1].ip, 
+                                      comm->peer_infos[peer - 1].port);
+        send_all(sock, &comm->rank, sizeof(int));
+        comm->peer_sockets[peer] = sock;
+    }
+    for (int i = 1; i < comm->rank; i++) {
+        int sock = accept(comm->listen_socket, NULL, NULL);
+        int peer;
+        recv_all(sock, &peer, sizeof(int));
+        comm->peer_sockets[peer] = sock;
+    }
+    
+    // The lower rank connected, it creates the shared memory
+    int* links = malloc(comm->size * sizeof(int));
+    bool* creator = malloc(comm->size * sizeof(bool));
+    for (int peer = 1; peer < comm->size; peer++) {
+        links[peer - 1] = comm->peer_sockets[peer];
+        creator[peer - 1] = peer > comm->rank;
+    }
+    links[comm->rank - 1] = -1;
+    shm_upgrade_links(links, creator, comm->size - 1);
+    free(links);
+    free(creator);
+    printf("[Rank %d] Peer links to all %d ranks ready\n", comm->rank, comm->size - 1);
+}
+
+typedef struct {
+    Communicator* comm;
+    int* data;
+    int* send_counts;
+    int* send_offsets;
+} AlltoallSender;
+
+// Sends run on their own thread so that large buckets cannot deadlock
+// against peers that are still sending to us.
+void* alltoall_send_thread(void* arg) {
+    AlltoallSender* sender = arg;
+    Communicator* comm = sender->comm;
+    for (int step = 1; step < comm->size; step++) {
+        int dest = (comm->rank + step) % comm->size;
+        send_array_on_socket(comm->peer_sockets[dest], 
+                             &sender->data[sender->send_offsets[dest]], 
+                             sender->send_counts[dest]);
+    }
+    return NULL;
+}
+
+// data holds one contiguous bucket per destination rank, in rank order.
+// Returns the received buckets in source rank order and their counts.
+int* alltoallv(Communicator* comm, int* data, int* send_counts, int* recv_counts) {
+    connect_peers(comm);
+    
+    int* send_offsets = malloc(comm->size * sizeof(int));
+    int offset = 0;
+    for (int i = 0; i < comm->size; i++) {
+        send_offsets[i] = offset;
+        offset += send_counts[i];
+    }
+    
+    AlltoallSender sender = {comm, data, send_counts, send_offsets};
+    pthread_t send_thread;
+    pthread_create(&send_thread, NULL, alltoall_send_thread, &sender);
+    
+    int** received = malloc(comm->size * sizeof(int*));
+    received[comm->rank] = &data[send_offsets[comm->rank]];
+    recv_counts[comm->rank] = send_counts[comm->rank];
+    for (int step = 1; step < comm->size; step++) {
+        int source = (comm->rank - step + comm->size) % comm->size;
+        received[source] = receive_array_on_socket(comm->peer_sockets[source], 
+                                                   &recv_counts[source]);
+    }
+    pthread_join(send_thread, NULL);
+    
+    int total = 0;
+    for (int i = 0; i < comm->size; i++) {
+        total += recv_counts[i];
+    }
+    int* result = malloc((total > 0 ? total : 1) * sizeof(int));
+    offset = 0;
+    for (int i = 0; i < comm->size; i++) {
+        memcpy(&result[offset], received[i], recv_counts[i] * sizeof(int));
+        offset += recv_counts[i];
+        if (i != comm->rank) free(received[i]);
+    }
+    
+    free(received);
+    free(send_offsets);
+    return result;
+}
+
+// ==================== Tree Collectives ====================
+
+// Binomial tree rooted at rank 0: the parent clears the lowest set bit,
+// so the subtree of rank r covers the contiguous ranks [r, r + lowbit(r)).
+int tree_parent(int rank) {
+    return rank & (rank - 1);
+}
+
+int tree_subtree_end(int rank, int size) {
+    if (rank == 0) return size;
+    int end = rank + (rank & -rank);
+    return (end < size) ? end : size;
+}
+
+int64_t reduce_int_tree(Communicator* comm, int64_t value, int64_t (*op)(int64_t, int64_t)) {
+    int64_t result = value;
+    for (int i = 0; i < comm->tree_child_count; i++) {
+        int64_t child_value;
+        recv_all(comm->tree_child_sockets[i], &child_value, sizeof(int64_t));
+        result = op(result, child_value);
+    }
+    
+    if (!comm->is_root) {
+        send_all(comm->tree_parent_socket, &result, sizeof(int64_t));
+    }
+    return result;
+}
+
+// Largest subtree first, it has the longest way to go
+void broadcast_string_tree(Communicator* comm, const char* message) {
+    int len = strlen(message) + 1;
+    for (int i = comm->tree_child_count - 1; i >= 0; i--) {
+        send_with_header(comm->tree_child_sockets[i], &len, sizeof(int), message, len);
+    }
+}
+
+char* receive_broadcast_tree(Communicator* comm) {
+    int len;
+    recv_all(comm->tree_parent_socket, &len, sizeof(int));
+    
+    char* message = malloc(len);
+    recv_all(comm->tree_parent_socket, message, len);
+    
+    broadcast_string_tree(comm, message);
+    return message;
+}
+
+void barrier_tree(Communicator* comm) {
+    reduce_int_tree(comm, 1, sum_op);
+    
+    int ack = 1;
+    if (!comm->is_root) {
+        recv_all(comm->tree_parent_socket, &ack, sizeof(int));
+    }
+    for (int i = comm->tree_child_count - 1; i >= 0; i--) {
+        send_all(comm->tree_child_sockets[i], &ack, sizeof(int));
+    }
+}
+
+// Every child receives the chunk sizes and data of its whole subtree,
+// keeps its own chunk and forwards the rest.
+int* scatter_tree(Communicator* comm, int* data, int* chunk_sizes, int* my_chunk_size) {
+    int* sizes = chunk_sizes;
+    int* subtree_data = data;
+    
+    if (!comm->is_root) {
+        int count;
+        sizes = receive_array_on_socket(comm->tree_parent_socket, &count);
+        subtree_data = receive_array_on_socket(comm->tree_parent_socket, &count);
+    }
+    
+    // Offsets are relative to this rank's first element
+    for (int i = comm->tree_child_count - 1; i >= 0; i--) {
+        int child = comm->tree_child_ranks[i];
+        int end = tree_subtree_end(child, comm->size);
+        int offset = 0, length = 0;
+        for (int r = comm->rank; r < child; r++) offset += sizes[r - comm->rank];
+        for (int r = child; r < end; r++) length += sizes[r - comm->rank];
+        
+        send_array_on_socket(comm->tree_child_sockets[i], &sizes[child - comm->rank], end - child);
+        send_array_on_socket(comm->tree_child_sockets[i], &subtree_data[offset], length);
+    }
+    
+    *my_chunk_size = sizes[0];
+    int* my_chunk = malloc(sizes[0] * sizeof(int));
+    memcpy(my_chunk, subtree_data, sizes[0] * sizeof(int));
+    
+    if (!comm->is_root) {
+        free(sizes);
+        free(subtree_data);
+    }
+    return my_chunk;
+}
+
+// ==================== Ring Collectives ====================
+
+// Block i of a count-element vector split over size ranks
+static void ring_block(int count, int size, int block, int* offset, int* length) {
+    *offset = (int)((long)count * block / size);
+    *length = (int)((long)count * (block + 1) / size) - *offset;
+}
+
+// One ring step: send to the next rank while the previous one sends to
+// us. Even ranks send first and odd ranks receive first, so the blocking
+// transfers cannot all wait on each other, whatever the buffer sizes.
+static void ring_exchange(Communicator* comm, const int64_t* send_data, int send_count,
+                          int64_t* recv_data, int recv_count) {
+    if (comm->rank % 2 == 0) {
+        send_all(comm->ring_next_socket, send_data, send_count * sizeof(int64_t));
+        recv_all(comm->ring_prev_socket, recv_data, recv_count * sizeof(int64_t));
+    } else {
+        recv_all(comm->ring_prev_socket, recv_data, recv_count * sizeof(int64_t));
+        send_all(comm->ring_next_socket, send_data, send_count * sizeof(int64_t));
+    }
+}
+
+// In place over the whole vector on every rank. Afterwards block `rank`
+// (returned length, *offset) holds the reduction over all ranks; the
+// other blocks hold partial results. Each link carries (P-1)/P of the data.
+int ring_reduce_scatter(Communicator* comm, int64_t* data, int count,
+                        int64_t (*op)(int64_t, int64_t), int* offset) {
+    int size = comm->size;
+    int my_offset, my_length;
+    ring_block(count, size, comm->rank, &my_offset, &my_length);
+    *offset = my_offset;
+    if (size == 1) return my_length;
+    
+    int64_t* incoming = malloc(((count + size - 1) / size + 1) * sizeof(int64_t));
+    for (int step = 0; step < size - 1; step++) {
+        int send_block = ((comm->rank - step - 1) % size + size) % size;
+        int recv_block = ((comm->rank - step - 2) % size + size) % size;
+        int send_offset, send_length, recv_offset, recv_length;
+        ring_block(count, size, send_block, &send_offset, &send_length);
+        ring_block(count, size, recv_block, &recv_offset, &recv_length);
+        
+        ring_exchange(comm, &data[send_offset], send_length, incoming, recv_length);
+        for (int i = 0; i < recv_length; i++) {
+            data[recv_offset + i] = op(data[recv_offset + i], incoming[i]);
+        }
+    }
+    
+    free(incoming);
+    return my_length;
+}
+
+// Reduce-scatter followed by a ring allgather of the finished blocks, so
+// every rank ends up with the full result and no link carries more than
+// 2(P-1)/P times the vector.
+void ring_allreduce(Communicator* comm, int64_t* data, int count,
+                    int64_t (*op)(int64_t, int64_t)) {
+    int size = comm->size;
+    int offset;
+    ring_reduce_scatter(comm, data, count, op, &offset);
+    
+    for (int step = 0; step < size - 1; step++) {
+        int send_block = ((comm->rank - step) % size + size) % size;
+        int recv_block = ((comm->rank - step - 1) % size + size) % size;
+        int send_offset, send_length, recv_offset, recv_length;
+        ring_block(count, size, send_block, &send_offset, &send_length);
+        ring_block(count, size, recv_block, &recv_offset, &recv_length);
+        
+        ring_exchange(comm, &data[send_offset], send_length, &data[recv_offset], recv_length);
+    }
+}
+
+// ==================== Shared-Memory Transport ====================
+
+// Channels by socket descriptor. Only changed while links are set up or
+// torn down, when no other thread of this rank communicates.
+static ShmChannel** shm_channels = NULL;
+static int shm_channel_capacity = 0;
+static unsigned int shm_segment_counter = 0;
+
+static ShmChannel* shm_channel(int sock) {
+    if (sock < 0 || sock >= shm_channel_capacity) return NULL;
+    return shm_channels[sock];
+}
+
+static void cpu_relax(void) {
+#if defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
+static void futex_wait(_Atomic uint32_t* word, uint32_t expected) {
+    struct timespec timeout = { 0, SHM_WAIT_MS * 1000000L };
+    syscall(SYS_futex, word, FUTEX_WAIT, expected, &timeout, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t* word) {
+    syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+// The socket carries no data once upgraded, so readable means EOF
+static bool shm_peer_alive(ShmChannel* ch) {
+    struct pollfd pfd = { .fd = ch->sock, .events = POLLIN };
+    if (poll(&pfd, 1, 0) <= 0) return true;
+    return !(pfd.revents & (POLLIN | POLLHUP | POLLERR));
+}
+
+// Spins briefly, then sleeps on seq until ready() holds. Returns false if
+// the peer went away while we were waiting.
+static bool shm_wait(ShmChannel* ch, _Atomic uint32_t* seq, _Atomic uint32_t* waiting,
+                     bool (*ready)(ShmRing*), ShmRing* ring) {
+    for (int spin = 0; spin < SHM_SPIN; spin++) {
+        if (ready(ring)) return true;
+        cpu_relax();
+    }
+    
+    while (true) {
+        atomic_store(waiting, 1);
+        uint32_t observed = atomic_load(seq);
+        if (ready(ring)) break;
+        futex_wait(seq, observed);
+        if (ready(ring)) break;
+        if (!shm_peer_alive(ch)) {
+            atomic_store(waiting, 0);
+            fprintf(stderr, "shared memory link: peer closed the connection\n");
+            return false;
+        }
+    }
+    atomic_store(waiting, 0);
+    return true;
+}
+
+static bool ring_has_data(ShmRing* ring) {
+    return atomic_load_explicit(&ring->head, memory_order_acquire) !=
+           atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+static bool ring_has_space(ShmRing* ring) {
+    return atomic_load_explicit(&ring->head, memory_order_relaxed) -
+           atomic_load_explicit(&ring->tail, memory_order_acquire) < SHM_RING_SIZE;
+}
+
+static bool shm_write(ShmChannel* ch, const void* buffer, size_t length) {
+    ShmRing* ring = ch->tx;
+    const char* ptr = buffer;
+    while (length > 0) {
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        size_t space = SHM_RING_SIZE - (size_t)(head - tail);
+        if (space == 0) {
+            if (!shm_wait(ch, &ring->space_seq, &ring->producer_waiting, ring_has_space, ring)) {
+                return false;
+            }
+            continue;
+        }
+        
+        size_t part = (length < space) ? length : space;
+        size_t offset = head % SHM_RING_SIZE;
+        size_t first = (part < SHM_RING_SIZE - offset) ? part : SHM_RING_SIZE - offset;
+        memcpy(&ring->data[offset], ptr, first);
+        memcpy(ring->data, ptr + first, part - first);
+        atomic_store_explicit(&ring->head, head + part, memory_order_release);
+        
+        atomic_fetch_add(&ring->data_seq, 1);
+        if (atomic_load(&ring->consumer_waiting)) futex_wake(&ring->data_seq);
+        ptr += part;
+        length -= part;
+    }
+    return true;
+}
+
+static bool shm_read(ShmChannel* ch, void* buffer, size_t length) {
+    ShmRing* ring = ch->rx;
+    char* ptr = buffer;
+    while (length > 0) {
+        uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        size_t available = (size_t)(head - tail);
+        if (available == 0) {
+            if (!shm_wait(ch, &ring->data_seq, &ring->consumer_waiting, ring_has_data, ring)) {
+                return false;
+            }
+            continue;
+        }
+        
+        size_t part = (length < available) ? length : available;
+        size_t offset = tail % SHM_RING_SIZE;
+        size_t first = (part < SHM_RING_SIZE - offset) ? part : SHM_RING_SIZE - offset;
+        memcpy(ptr, &ring->data[offset], first);
+        memcpy(ptr + first, ring->data, part - first);
+        atomic_store_explicit(&ring->tail, tail + part, memory_order_release);
+        
+        atomic_fetch_add(&ring->space_seq, 1);
+        if (atomic_load(&ring->producer_waiting)) futex_wake(&ring->space_seq);
+        ptr += part;
+        length -= part;
+    }
+    return true;
+}
+
+// Ranks share memory if they run under the same kernel boot and hostname.
+// A container with its own /dev/shm fails to open the segment instead,
+// and the link stays on TCP.
+static const char* host_identity(void) {
+    static char identity[128];
+    if (identity[0]) return identity;
+    
+    FILE* f = fopen("/proc/sys/kernel/random/boot_id", "r");
+    if (f) {
+        if (!fgets(identity, 64, f)) identity[0] = '\0';
+        fclose(f);
+    }
+    identity[strcspn(identity, "\n")] = '\0';
+    size_t used = strlen(identity);
+    identity[used++] = '@';
+    gethostname(&identity[used], sizeof(identity) - used - 1);
+    return identity;
+}
+
+static void shm_register(int sock, void* segment, bool creator) {
+    if (sock >= shm_channel_capacity) {
+        int capacity = (sock + 1 > 2 * shm_channel_capacity) ? sock + 1 : 2 * shm_channel_capacity;
+        shm_channels = realloc(shm_channels, capacity * sizeof(ShmChannel*));
+        for (int i = shm_channel_capacity; i < capacity; i++) shm_channels[i] = NULL;
+        shm_channel_capacity = capacity;
+    }
+    
+    ShmRing* rings = segment;
+    ShmChannel* ch = malloc(sizeof(ShmChannel));
+    ch->segment = segment;
+    ch->tx = creator ? &rings[0] : &rings[1];
+    ch->rx = creator ? &rings[1] : &rings[0];
+    ch->sock = sock;
+    shm_channels[sock] = ch;
+}
+
+static void* shm_create_segment(char* name, size_t name_size) {
+    snprintf(name, name_size, "/pc-%d-%u", (int)getpid(), shm_segment_counter++);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return NULL;
+    
+    // Reserve the pages now, a full tmpfs would otherwise SIGBUS later
+    void* segment = NULL;
+    if (posix_fallocate(fd, 0, 2 * sizeof(ShmRing)) == 0) {
+        segment = mmap(NULL, 2 * sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (segment == MAP_FAILED) segment = NULL;
+    }
+    close(fd);
+    if (!segment) shm_unlink(name);
+    return segment;
+}
+
+static void* shm_open_segment(const char* name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    void* segment = mmap(NULL, 2 * sizeof(ShmRing), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    return (segment == MAP_FAILED) ? NULL : segment;
+}
+
+typedef struct {
+    char host[128];
+    bool shm;
+} ShmHello;
+
+// Collective over the given links; both ends of every link must call it
+// with opposite creator flags. Runs in passes so that no rank waits for
+// another one to finish its own links first:
+//   1. hello (host identity) on every link
+//   2. creators of co-located links create a segment and send its name
+//   3. joiners map the segment and answer with an ack
+//   4. creators read the ack and unlink the name
+void shm_upgrade_links(const int* sockets, const bool* creator, int count) {
+    if (count == 0) return;
+    
+    ShmHello hello;
+    memset(&hello, 0, sizeof(hello));
+    snprintf(hello.host, sizeof(hello.host), "%s", host_identity());
+    hello.shm = options.shm;
+    
+    bool* local = calloc(count, sizeof(bool));
+    void** segments = calloc(count, sizeof(void*));
+    char (*names)[64] = calloc(count, sizeof(*names));
+    
+    for (int i = 0; i < count; i++) {
+        if (sockets[i] >= 0) send_all(sockets[i], &hello, sizeof(hello));
+    }
+    for (int i = 0; i < count; i++) {
+        if (sockets[i] < 0) continue;
+        ShmHello peer;
+        recv_all(sockets[i], &peer, sizeof(peer));
+        local[i] = hello.shm && peer.shm && strcmp(hello.host, peer.host) == 0;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (!local[i] || !creator[i]) continue;
+        segments[i] = shm_create_segment(names[i], sizeof(names[i]));
+        if (!segments[i]) names[i][0] = '\0';
+        send_all(sockets[i], names[i], sizeof(names[i]));
+    }
+    
+    for (int i = 0; i < count; i++) {
+        if (!local[i] || creator[i]) continue;
+        recv_all(sockets[i], names[i], sizeof(names[i]));
+        if (names[i][0]) segments[i] = shm_open_segment(names[i]);
+        bool ack = segments[i] != NULL;
+        send_all(sockets[i], &ack, sizeof(bool));
+        if (ack) shm_register(sockets[i], segments[i], false);
+    }
+    
+    int links = 0, upgraded = 0;
+    for (int i = 0; i < count; i++) {
+        if (sockets[i] >= 0) links++;
+        if (!local[i]) continue;
+        if (creator[i]) {
+            bool ack = false;
+            recv_all(sockets[i], &ack, sizeof(bool));
+            if (segments[i]) {
+                shm_unlink(names[i]);
+                if (ack) {
+                    shm_register(sockets[i], segments[i], true);
+                } else {
+                    munmap(segments[i], 2 * sizeof(ShmRing));
+                }
+            }
+        }
+        if (shm_channel(sockets[i])) upgraded++;
+    }
+    if (upgraded > 0) {
+        printf("Shared memory on %d of %d link(s)\n", upgraded, links);
+    }
+    
+    free(local);
+    free(segments);
+    free(names);
+}
+
+void shm_detach(int sock) {
+    ShmChannel* ch = shm_channel(sock);
+    if (!ch) return;
+    munmap(ch->segment, 2 * sizeof(ShmRing));
+    free(ch);
+    shm_channels[sock] = NULL;
+}
+
+void close_link(int sock) {
+    shm_detach(sock);
+    close(sock);
+}
+
+// ==================== Bulk Transfer ====================
+
+// send() may move fewer bytes than asked for, loop until all are out
+bool send_all(int sock, const void* buffer, size_t length) {
+    ShmChannel* ch = shm_channel(sock);
+    if (ch) return shm_write(ch, buffer, length);
+    
+    const char* ptr = buffer;
+    while (length > 0) {
+        ssize_t sent = send(sock, ptr, length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            perror("send failed");
+            return false;
+        }
+        ptr += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+bool recv_all(int sock, void* buffer, size_t length) {
+    ShmChannel* ch = shm_channel(sock);
+    if (ch) return shm_read(ch, buffer, length);
+    
+    char* ptr = buffer;
+    while (length > 0) {
+        ssize_t received = recv(sock, ptr, length, 0);
+        if (received < 0) {
+            if (errno == EINTR) continue;
+            perror("recv failed");
+            return false;
+        }
+        if (received == 0) {
+            fprintf(stderr, "recv failed: connection closed by peer\n");
+            return false;
+        }
+        ptr += received;
+        length -= received;
+    }
+    return true;
+}
+
+#ifdef MSG_ZEROCOPY
+// Zero-copy sends pin the pages until the kernel reports completion on the
+// socket error queue, so wait for all `pending` notifications before the
+// caller may touch the buffer again.
+static bool wait_zerocopy_completions(int sock, unsigned int pending) {
+    while (pending > 0) {
+        struct pollfd pfd = { .fd = sock, .events = 0 };
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (!(pfd.revents & POLLERR)) {
+            fprintf(stderr, "Connection lost while waiting for zero-copy completion\n");
+            return false;
+        }
+        
+        char control[128];
+        struct msghdr msg = { .msg_control = control, .msg_controllen = sizeof(control) };
+        if (recvmsg(sock, &msg, MSG_ERRQUEUE) < 0) {
+            if (errno == EAGAIN || errno == EINTR) continue;
+            return false;
+        }
+        
+        for (struct cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            struct sock_extended_err* err = (struct sock_extended_err*)CMSG_DATA(cm);
+            if (err->ee_errno == 0 && err->ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+                // ee_info..ee_data is the range of completed sendmsg calls
+                unsigned int completed = err->ee_data - err->ee_info + 1;
+                pending = (completed < pending) ? pending - completed : 0;
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+// Header and payload leave in one sendmsg; partial writes advance the iovecs
+bool send_with_header(int sock, const void* header, size_t header_length,
+                      const void* payload, size_t payload_length) {
+    ShmChannel* ch = shm_channel(sock);
+    if (ch) return shm_write(ch, header, header_length) && shm_write(ch, payload, payload_length);
+    
+    struct iovec iov[2] = {
+        { .iov_base = (void*)header, .iov_len = header_length },
+        { .iov_base = (void*)payload, .iov_len = payload_length }
+    };
+    struct iovec* current = iov;
+    int iov_count = (payload_length > 0) ? 2 : 1;
+    
+    int flags = MSG_NOSIGNAL;
+#ifdef MSG_ZEROCOPY
+    unsigned int zerocopy_sends = 0;
+    int one = 1;
+    if (payload_length >= ZEROCOPY_THRESHOLD &&
+        setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0) {
+        flags |= MSG_ZEROCOPY;
+    }
+#endif
+    
+    while (iov_count > 0) {
+        struct msghdr msg = { .msg_iov = current, .msg_iovlen = iov_count };
+        ssize_t sent = sendmsg(sock, &msg, flags);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+#ifdef MSG_ZEROCOPY
+            // Out of optmem for pinned pages, fall back to copying
+            if (errno == ENOBUFS && (flags & MSG_ZEROCOPY)) {
+                flags &= ~MSG_ZEROCOPY;
+                continue;
+            }
+#endif
+            perror("sendmsg failed");
+            return false;
+        }
+#ifdef MSG_ZEROCOPY
+        if (flags & MSG_ZEROCOPY) zerocopy_sends++;
+#endif
+        
+        while (iov_count > 0 && (size_t)sent >= current->iov_len) {
+            sent -= current->iov_len;
+            current++;
+            iov_count--;
+        }
+        if (iov_count > 0) {
+            current->iov_base = (char*)current->iov_base + sent;
+            current->iov_len -= sent;
+        }
+    }
+    
+#ifdef MSG_ZEROCOPY
+    if (zerocopy_sends > 0) {
+        return wait_zerocopy_completions(sock, zerocopy_sends);
+    }
+#endif
+    return true;
+}
+
+void send_array_on_socket(int sock, const int* data, int length) {
+    send_with_header(sock, &length, sizeof(int), data, (size_t)length * sizeof(int));
+}
+
+int* receive_array_on_socket(int sock, int* length) {
+    *length = 0;
+    if (!recv_all(sock, length, sizeof(int))) return NULL;
+    
+    int* data = malloc((*length > 0 ? *length : 1) * sizeof(int));
+    if (!recv_all(sock, data, (size_t)*length * sizeof(int))) {
+        free(data);
+        *length = 0;
+        return NULL;
+    }
+    return data;
+}
+
+// Receives straight into the caller's buffer. Returns the length, or -1 if
+// the message does not fit (it is drained so the stream stays in sync).
+int receive_array_on_socket_into(int sock, int* buffer, int capacity) {
+    int length;
+    if (!recv_all(sock, &length, sizeof(int))) return -1;
+    
+    if (length > capacity) {
+        fprintf(stderr, "Array of %d elements exceeds buffer of %d\n", length, capacity);
+        int discard[256];
+        size_t remaining = (size_t)length * sizeof(int);
+        while (remaining > 0) {
+            size_t part = (remaining < sizeof(discard)) ? remaining : sizeof(discard);
+            if (!recv_all(sock, discard, part)) break;
+            remaining -= part;
+        }
+        return -1;
+    }
+    
+    if (!recv_all(sock, buffer, (size_t)length * sizeof(int))) return -1;
+    return length;
+}
+
+// ==================== Neighbor Communication ====================
+
+void send_to_left_neighbor(Communicator* comm, int value) {
+    if (comm->has_left_neighbor) {
+        send_all(comm->left_neighbor_socket, &value, sizeof(int));
+    }
+}
+
+void send_to_right_neighbor(Communicator* comm, int value) {
+    if (comm->has_right_neighbor) {
+        send_all(comm->right_neighbor_socket, &value, sizeof(int));
+    }
+}
+
+int receive_from_left_neighbor(Communicator* comm) {
+    int value = 0;
+    if (comm->has_left_neighbor) {
+        recv_all(comm->left_neighbor_socket, &value, sizeof(int));
+    }
+    return value;
+}
+
+int receive_from_right_neighbor(Communicator* comm) {
+    int value = 0;
+    if (comm->has_right_neighbor) {
+        recv_all(comm->right_neighbor_socket, &value, sizeof(int));
+    }
+    return value;
+}
+
+void send_array_to_left_neighbor(Communicator* comm, int* data, int length) {
+    if (comm->has_left_neighbor) {
+        send_array_on_socket(comm->left_neighbor_socket, data, length);
+    }
+}
+
+void send_array_to_right_neighbor(Communicator* comm, int* data, int length) {
+    if (comm->has_right_neighbor) {
+        send_array_on_socket(comm->right_neighbor_socket, data, length);
+    }
+}
+
+int* receive_array_from_left_neighbor(Communicator* comm, int* length) {
+    *length = 0;
+    if (!comm->has_left_neighbor) return NULL;
+    return receive_array_on_socket(comm->left_neighbor_socket, length);
+}
+
+int receive_array_from_left_neighbor_into(Communicator* comm, int* buffer, int capacity) {
+    if (!comm->has_left_neighbor) return -1;
+    return receive_array_on_socket_into(comm->left_neighbor_socket, buffer, capacity);
+}
+
+int* receive_array_from_right_neighbor(Communicator* comm, int* length) {
+    *length = 0;
+    if (!comm->has_right_neighbor) return NULL;
+    return receive_array_on_socket(comm->right_neighbor_socket, length);
+}
+
+int receive_array_from_right_neighbor_into(Communicator* comm, int* buffer, int capacity) {
+    if (!comm->has_right_neighbor) return -1;
+    return receive_array_on_socket_into(comm->right_neighbor_socket, buffer, capacity);
+}
+
+// ==================== Algorithm Implementations ====================
+
+void* sum_algorithm(Communicator* comm, int* local_data, int length) {
+    int64_t local_sum = parallel_sum(local_data, length);
+    
+    printf("[Rank %d] Local sum: %" PRId64 "\n", comm->rank, local_sum);
+    
+    if (comm->is_root) {
+        int64_t result = reduce_int(comm, local_sum, sum_op);
+        int64_t* result_ptr = malloc(sizeof(int64_t));
+        *result_ptr = result;
+        return result_ptr;
+    } else {
+        reduce_int(comm, local_sum, sum_op);
+        return NULL;
+    }
+}
+
+void* min_algorithm(Communicator* comm, int* local_data, int length) {
+    // Empty chunks (more ranks than elements) contribute the identity
+    int local_min = parallel_min(local_data, length);
+    
+    printf("[Rank %d] Local minimum: %d\n", comm->rank, local_min);
+    
+    if (comm->is_root) {
+        int result = (int)reduce_int(comm, local_min, min_op);
+        int* result_ptr = malloc(sizeof(int));
+        *result_ptr = result;
+        return result_ptr;
+    } else {
+        reduce_int(comm, local_min, min_op);
+        return NULL;
+    }
+}
+
+void* max_algorithm(Communicator* comm, int* local_data, int length) {
+    int local_max = parallel_max(local_data, length);
+    
+    printf("[Rank %d] Local maximum: %d\n", comm->rank, local_max);
+    
+    if (comm->is_root) {
+        int result = (int)reduce_int(comm, local_max, max_op);
+        int* result_ptr = malloc(sizeof(int));
+        *result_ptr = result;
+        return result_ptr;
+    } else {
+        reduce_int(comm, local_max, max_op);
+        return NULL;
+    }
+}
+
+// ==================== Parallel Sort Implementation ====================
+
+typedef struct {
+    Communicator* comm;
+    int* local_data;
+    int length;
+    SortMode mode;
+    int* scratch;   // Merge buffer for block mode
+    int* neighbor_data;   // Receive buffer for the neighbor's chunk
+    int neighbor_capacity;
+} SortContext;
+
+bool execute_phase(SortContext* ctx, const char* phase);
+bool exchange_with_right(SortContext* ctx);
+bool receive_from_left(SortContext* ctx);
+bool merge_split_with_right(SortContext* ctx);
+bool merge_split_with_left(SortContext* ctx);
+void presort(int* data, int length);
+
+void* sort_algorithm(Communicator* comm, int* local_data, int length) {
+    SortContext ctx = {comm, local_data, length, options.sort_mode, NULL, NULL, 0};
+    
+    // Phase 1: Synchronized presort, the coordinator decides the sort mode
+    if (comm->is_root) {
+        broadcast_string(comm, "PRESORT");
+        broadcast_string(comm, sort_mode_name(ctx.mode));
+    } else {
+        char* cmd = receive_broadcast(comm);
+        free(cmd);
+        char* mode = receive_broadcast(comm);
+        ctx.mode = (strcmp(mode, sort_mode_name(SORT_MODE_ELEMENT)) == 0) ?
+                   SORT_MODE_ELEMENT : SORT_MODE_BLOCK;
+        free(mode);
+    }
+    printf("[Rank %d] Sort mode: %s\n", comm->rank, sort_mode_name(ctx.mode));
+    
+    if (ctx.mode == SORT_MODE_BLOCK) {
+        ctx.scratch = malloc((length > 0 ? length : 1) * sizeof(int));
+    }
+    
+    presort(local_data, length);
+    
+    barrier(comm);
+    printf("[Rank %d] Presort completed, waiting at barrier\n", comm->rank);
+    
+    // Phase 2: Odd-Even rounds
+    bool global_swapped = true;
+    int round = 0;
+    
+    while (global_swapped) {
+        round++;
+        printf("\n[Rank %d] ========== ROUND %d ==========\n", comm->rank, round);
+        
+        // ODD phase
+        if (comm->is_root) {
+            broadcast_string(comm, "ODD");
+        } else {
+            char* phase = receive_broadcast(comm);
+            free(phase);
+        }
+        
+        printf("[Rank %d] ODD PHASE - Array before: [", comm->rank);
+        for (int i = 0; i < length; i++) {
+            printf("%d%s", local_data[i], (i < length - 1) ? ", " : "");
+        }
+        printf("]\n");
+        
+        bool local_odd_swap = execute_phase(&ctx, "ODD");
+        bool global_odd_swap = reduce_bool(comm, local_odd_swap);
+        
+        // EVEN phase
+        if (comm->is_root) {
+            broadcast_string(comm, "EVEN");
+        } else {
+            char* phase = receive_broadcast(comm);
+            free(phase);
+        }
+        
+        printf("[Rank %d] EVEN PHASE - Array before: [", comm->rank);
+        for (int i = 0; i < length; i++) {
+            printf("%d%s", local_data[i], (i < length - 1) ? ", " : "");
+        }
+        printf("]\n");
+        
+        bool local_even_swap = execute_phase(&ctx, "EVEN");
+        bool global_even_swap = reduce_bool(comm, local_even_swap);
+        
+        // Check if we should continue
+        if (comm->is_root) {
+            global_swapped = global_odd_swap || global_even_swap;
+            printf("[Coordinator] Round %d complete. Global swaps: %s\n", 
+                   round, global_swapped ? "true" : "false");
+            
+            // P merge-split phases always sort P blocks, no extra round needed
+            if (ctx.mode == SORT_MODE_BLOCK && global_swapped && 2 * round >= comm->size) {
+                printf("[Coordinator] %d phases done, blocks are sorted\n", 2 * round);
+                global_swapped = false;
+            }
+            
+            broadcast_string(comm, global_swapped ? "CONTINUE" : "DONE");
+        } else {
+            char* decision = receive_broadcast(comm);
+            global_swapped = (strcmp(decision, "CONTINUE") == 0);
+            free(decision);
+        }
+    }
+    
+    free(ctx.scratch);
+    free(ctx.neighbor_data);
+    
+    // Phase 3: Gather sorted data
+    if (comm->is_root) {
+        broadcast_string(comm, "GATHER");
+    } else {
+        char* gather_cmd = receive_broadcast(comm);
+        free(gather_cmd);
+    }
+    return gather_sorted_result(comm, local_data, length);
+}
+
+bool execute_phase(SortContext* ctx, const char* phase) {
+    bool is_odd_phase = (strcmp(phase, "ODD") == 0);
+    bool is_active = (ctx->comm->rank % 2 == 1 && is_odd_phase) || 
+                     (ctx->comm->rank % 2 == 0 && !is_odd_phase);
+    
+    if (is_active && ctx->comm->has_right_neighbor) {
+        printf("[Rank %d] %s PHASE: I am ACTIVE, exchanging with right neighbor\n", 
+               ctx->comm->rank, phase);
+        return (ctx->mode == SORT_MODE_BLOCK) ? merge_split_with_right(ctx)
+                                              : exchange_with_right(ctx);
+    } else if (!is_active && ctx->comm->has_left_neighbor) {
+        printf("[Rank %d] %s PHASE: I am PASSIVE, waiting for left neighbor\n", 
+               ctx->comm->rank, phase);
+        return (ctx->mode == SORT_MODE_BLOCK) ? merge_split_with_left(ctx)
+                                              : receive_from_left(ctx);
+    } else {
+        printf("[Rank %d] %s PHASE: No neighbor to exchange with\n", 
+               ctx->comm->rank, phase);
+        return false;
+    }
+}
+
+bool exchange_with_right(SortContext* ctx) {
+    int my_value = ctx->local_data[ctx->length - 1];
+    printf("[Rank %d] ACTIVE: Sending to right: %d\n", ctx->comm->rank, my_value);
+    
+    send_to_right_neighbor(ctx->comm, my_value);
+    int neighbor_value = receive_from_right_neighbor(ctx->comm);
+    printf("[Rank %d] ACTIVE: Received from right: %d\n", ctx->comm->rank, neighbor_value);
+    
+    if (my_value > neighbor_value) {
+        printf("[Rank %d] ACTIVE: SWAP! My %d > neighbor's %d\n", 
+               ctx->comm->rank, my_value, neighbor_value);
+        ctx->local_data[ctx->length - 1] = neighbor_value;
+        insert_from_right(ctx->local_data, ctx->length);
+        
+        printf("[Rank %d] ACTIVE: Array after swap: [", ctx->comm->rank);
+        for (int i = 0; i < ctx->length; i++) {
+            printf("%d%s", ctx->local_data[i], (i < ctx->length - 1) ? ", " : "");
+        }
+        printf("]\n");
+        return true;
+    }
+    
+    printf("[Rank %d] ACTIVE: NO SWAP - My %d <= neighbor's %d\n", 
+           ctx->comm->rank, my_value, neighbor_value);
+    return false;
+}
+
+bool receive_from_left(SortContext* ctx) {
+    int received_value = receive_from_left_neighbor(ctx->comm);
+    int my_value = ctx->local_data[0];
+    
+    printf("[Rank %d] PASSIVE: Received from left: %d\n", ctx->comm->rank, received_value);
+    printf("[Rank %d] PASSIVE: My first value: %d\n", ctx->comm->rank, my_value);
+    
+    if (received_value > my_value) {
+        printf("[Rank %d] PASSIVE: SWAP! Neighbor's %d > my %d\n", 
+               ctx->comm->rank, received_value, my_value);
+        send_to_left_neighbor(ctx->comm, my_value);
+        printf("[Rank %d] PASSIVE: Sent back to left: %d\n", ctx->comm->rank, my_value);
+        
+        ctx->local_data[0] = received_value;
+        insert_from_left(ctx->local_data, ctx->length);
+        
+        printf("[Rank %d] PASSIVE: Array after swap: [", ctx->comm->rank);
+        for (int i = 0; i < ctx->length; i++) {
+            printf("%d%s", ctx->local_data[i], (i < ctx->length - 1) ? ", " : "");
+        }
+        printf("]\n");
+        return true;
+    } else {
+        printf("[Rank %d] PASSIVE: NO SWAP - Neighbor's %d <= my %d\n", 
+               ctx->comm->rank, received_value, my_value);
+        send_to_left_neighbor(ctx->comm, received_value);
+        printf("[Rank %d] PASSIVE: Sent back to left: %d\n", ctx->comm->rank, received_value);
+        return false;
+    }
+}
+
+// Block mode: both sides first swap {length, boundary value}, so already
+// ordered pairs skip the chunk transfer and the receiver can size its buffer.
+static int* reserve_neighbor_buffer(SortContext* ctx, int length) {
+    if (length > ctx->neighbor_capacity) {
+        free(ctx->neighbor_data);
+        ctx->neighbor_data = malloc(length * sizeof(int));
+        ctx->neighbor_capacity = length;
+    }
+    return ctx->neighbor_data;
+}
+
+// The active (left) rank keeps the lower half of both chunks
+bool merge_split_with_right(SortContext* ctx) {
+    int mine[2] = { ctx->length, (ctx->length > 0) ? ctx->local_data[ctx->length - 1] : 0 };
+    int theirs[2];
+    send_array_to_right_neighbor(ctx->comm, mine, 2);
+    receive_array_from_right_neighbor_into(ctx->comm, theirs, 2);
+    
+    if (mine[0] == 0 || theirs[0] == 0 || mine[1] <= theirs[1]) {
+        printf("[Rank %d] ACTIVE: Blocks already ordered, no merge-split\n", ctx->comm->rank);
+        return false;
+    }
+    printf("[Rank %d] ACTIVE: My max %d > neighbor's min %d, merge-split\n", 
+           ctx->comm->rank, mine[1], theirs[1]);
+    
+    int* neighbor_data = reserve_neighbor_buffer(ctx, theirs[0]);
+    send_array_to_right_neighbor(ctx->comm, ctx->local_data, ctx->length);
+    int neighbor_length = receive_array_from_right_neighbor_into(ctx->comm, neighbor_data, 
+                                                                 ctx->neighbor_capacity);
+    merge_keep_low(ctx->local_data, ctx->length, neighbor_data, neighbor_length, ctx->scratch);
+    
+    printf("[Rank %d] ACTIVE: Kept lower %d elements: [", ctx->comm->rank, ctx->length);
+    for (int i = 0; i < ctx->length; i++) {
+        printf("%d%s", ctx->local_data[i], (i < ctx->length - 1) ? ", " : "");
+    }
+    printf("]\n");
+    return true;
+}
+
+// The passive (right) rank keeps the upper half of both chunks
+bool merge_split_with_left(SortContext* ctx) {
+    int mine[2] = { ctx->length, (ctx->length > 0) ? ctx->local_data[0] : 0 };
+    int theirs[2];
+    receive_array_from_left_neighbor_into(ctx->comm, theirs, 2);
+    send_array_to_left_neighbor(ctx->comm, mine, 2);
+    
+    if (mine[0] == 0 || theirs[0] == 0 || theirs[1] <= mine[1]) {
+        printf("[Rank %d] PASSIVE: Blocks already ordered, no merge-split\n", ctx->comm->rank);
+        return false;
+    }
+    printf("[Rank %d] PASSIVE: Neighbor's max %d > my min %d, merge-split\n", 
+           ctx->comm->rank, theirs[1], mine[1]);
+    
+    int* neighbor_data = reserve_neighbor_buffer(ctx, theirs[0]);
+    int neighbor_length = receive_array_from_left_neighbor_into(ctx->comm, neighbor_data, 
+                                                                ctx->neighbor_capacity);
+    send_array_to_left_neighbor(ctx->comm, ctx->local_data, ctx->length);
+    merge_keep_high(ctx->local_data, ctx->length, neighbor_data, neighbor_length, ctx->scratch);
+    
+    printf("[Rank %d] PASSIVE: Kept upper %d elements: [", ctx->comm->rank, ctx->length);
+    for (int i = 0; i < ctx->length; i++) {
+        printf("%d%s", ctx->local_data[i], (i < ctx->length - 1) ? ", " : "");
+    }
+    printf("]\n");
+    return true;
+}
+
+void presort(int* data, int length) {
+    parallel_sort(data, length);
+    printf("[Rank %d] Presorted: [", 0); // Will be filled with actual rank
+    for (int i = 0; i < length; i++) {
+        printf("%d%s", data[i], (i < length - 1) ? ", " : "");
+    }
+    printf("]\n");
+}
+
+// ==================== Parallel Sample Sort (PSRS) ====================
+
+void* samplesort_algorithm(Communicator* comm, int* local_data, int length) {
+    int size = comm->size;
+    
+    // Phase 1: Local sort
+    parallel_sort(local_data, length);
+    printf("[Rank %d] Locally sorted %d elements\n", comm->rank, length);
+    
+    // Phase 2: Regular samples to the coordinator, P-1 splitters back
+    int sample_count = (length < size) ? length : size;
+    int* samples = malloc((sample_count > 0 ? sample_count : 1) * sizeof(int));
+    for (int i = 0; i < sample_count; i++) {
+        samples[i] = local_data[(long)i * length / sample_count];
+    }
+    
+    int splitter_count;
+    int* splitters;
+    if (comm->is_root) {
+        int* sample_lengths = malloc(size * sizeof(int));
+        int** all_samples = gather(comm, samples, sample_count, sample_lengths);
+        
+        int total_samples = 0;
+        for (int i = 0; i < size; i++) {
+            total_samples += sample_lengths[i];
+        }
+        int* pool = malloc((total_samples > 0 ? total_samples : 1) * sizeof(int));
+        int index = 0;
+        for (int i = 0; i < size; i++) {
+            memcpy(&pool[index], all_samples[i], sample_lengths[i] * sizeof(int));
+            index += sample_lengths[i];
+            free(all_samples[i]);
+        }
+        quick_sort(pool, total_samples);
+        
+        splitter_count = size - 1;
+        splitters = malloc((splitter_count > 0 ? splitter_count : 1) * sizeof(int));
+        for (int i = 1; i < size; i++) {
+            splitters[i - 1] = (total_samples > 0) ? pool[(long)i * total_samples / size] : 0;
+        }
+        broadcast_int_array(comm, splitters, splitter_count);
+        
+        printf("[Coordinator] Splitters: [");
+        for (int i = 0; i < splitter_count; i++) {
+            printf("%d%s", splitters[i], (i < splitter_count - 1) ? ", " : "");
+        }
+        printf("]\n");
+        
+        free(pool);
+        free(all_samples);
+        free(sample_lengths);
+    } else {
+        gather(comm, samples, sample_count, NULL);
+        splitters = receive_broadcast_int_array(comm, &splitter_count);
+    }
+    free(samples);
+    
+    // Phase 3: Split into buckets, bucket i holds the values <= splitters[i]
+    int* send_counts = malloc(size * sizeof(int));
+    int* recv_counts = malloc(size * sizeof(int));
+    int start = 0;
+    for (int i = 0; i < size; i++) {
+        int end = (i < size - 1) ? upper_bound(local_data, start, length, splitters[i]) : length;
+        send_counts[i] = end - start;
+        start = end;
+    }
+    
+    // Phase 4: All-to-all bucket exchange and local merge of the P sorted runs
+    int* received = alltoallv(comm, local_data, send_counts, recv_counts);
+    int new_length = 0;
+    for (int i = 0; i < size; i++) {
+        new_length += recv_counts[i];
+    }
+    int* bucket = malloc((new_length > 0 ? new_length : 1) * sizeof(int));
+    merge_runs(received, recv_counts, size, bucket);
+    printf("[Rank %d] Bucket exchange done, holding %d elements\n", comm->rank, new_length);
+    
+    free(received);
+    free(send_counts);
+    free(recv_counts);
+    free(splitters);
+    
+    // Phase 5: Gather the buckets, they are already in global order
+    int* final_result = gather_sorted_result(comm, bucket, new_length);
+    free(bucket);
+    return final_result;
+}
+
+// ==================== Thread Pool ====================
+
+static void* thread_pool_worker(void* arg) {
+    ThreadPool* pool = arg;
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (!pool->shutdown && pool->next_task >= pool->task_count) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        
+        int index = pool->next_task++;
+        pthread_mutex_unlock(&pool->lock);
+        pool->task(pool->task_arg, index);
+        pthread_mutex_lock(&pool->lock);
+        
+        if (--pool->unfinished == 0) {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+ThreadPool* thread_pool_create(int thread_count) {
+    ThreadPool* pool = malloc(sizeof(ThreadPool));
+    pool->thread_count = thread_count;
+    pool->threads = malloc(thread_count * sizeof(pthread_t));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+    pool->task = NULL;
+    pool->task_arg = NULL;
+    pool->task_count = 0;
+    pool->next_task = 0;
+    pool->unfinished = 0;
+    pool->shutdown = false;
+    
+    for (int i = 1; i < thread_count; i++) {
+        pthread_create(&pool->threads[i], NULL, thread_pool_worker, pool);
+    }
+    return pool;
+}
+
+// Runs task(arg, 0..task_count-1) and returns when all are done
+void thread_pool_run(ThreadPool* pool, ParallelTask task, void* arg, int task_count) {
+    if (pool->thread_count <= 1 || task_count <= 1) {
+        for (int i = 0; i < task_count; i++) {
+            task(arg, i);
+        }
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->task_arg = arg;
+    pool->task_count = task_count;
+    pool->next_task = 0;
+    pool->unfinished = task_count;
+    pthread_cond_broadcast(&pool->work_ready);
+    
+    // Help with the work, then wait for the tasks still running elsewhere
+    while (pool->next_task < pool->task_count) {
+        int index = pool->next_task++;
+        pthread_mutex_unlock(&pool->lock);
+        task(arg, index);
+        pthread_mutex_lock(&pool->lock);
+        pool->unfinished--;
+    }
+    while (pool->unfinished > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pool->task_count = 0;
+    pool->next_task = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+    
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+    
+    for (int i = 1; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    free(pool->threads);
+    free(pool);
+}
+
+// ==================== Parallel Local Kernels ====================
+
+// Small arrays stay on one thread, the pool overhead would dominate
+int parallel_task_count(int length) {
+    int tasks = length / PARALLEL_GRAIN;
+    if (tasks > thread_pool->thread_count) tasks = thread_pool->thread_count;
+    return (tasks > 1) ? tasks : 1;
+}
+
+// ==================== SIMD Reduction Kernels ====================
+
+// Each kernel reduces one contiguous slice. Sums widen to 64-bit lanes
+// before adding, so they cannot overflow for any int array that fits in
+// memory. The widest variant the CPU supports is chosen once in main().
+typedef struct {
+    const char* name;
+    int64_t (*sum)(const int* data, int length);
+    int (*min)(const int* data, int length);
+    int (*max)(const int* data, int length);
+} ReductionKernels;
+
+int64_t sum_scalar(const int* data, int length) {
+    int64_t sum = 0;
+    for (int i = 0; i < length; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+int min_scalar(const int* data, int length) {
+    int min = INT_MAX;
+    for (int i = 0; i < length; i++) {
+        if (data[i] < min) min = data[i];
+    }
+    return min;
+}
+
+int max_scalar(const int* data, int length) {
+    int max = INT_MIN;
+    for (int i = 0; i < length; i++) {
+        if (data[i] > max) max = data[i];
+    }
+    return max;
+}
+
+static ReductionKernels reduction_kernels = {
+    "scalar", sum_scalar, min_scalar, max_scalar
+};
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.1")))
+static int64_t sum_sse41(const int* data, int length) {
+    __m128i acc0 = _mm_setzero_si128();
+    __m128i acc1 = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= length; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+        acc0 = _mm_add_epi64(acc0, _mm_cvtepi32_epi64(v));
+        acc1 = _mm_add_epi64(acc1, _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)));
+    }
+    __m128i acc = _mm_add_epi64(acc0, acc1);
+    int64_t sum = _mm_cvtsi128_si64(acc) + _mm_extract_epi64(acc, 1);
+    return sum + sum_scalar(data + i, length - i);
+}
+
+__attribute__((target("sse4.1")))
+static int min_sse41(const int* data, int length) {
+    __m128i acc = _mm_set1_epi32(INT_MAX);
+    int i = 0;
+    for (; i + 4 <= length; i += 4) {
+        acc = _mm_min_epi32(acc, _mm_loadu_si128((const __m128i*)(data + i)));
+    }
+    acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_min_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    int min = _mm_cvtsi128_si32(acc);
+    int tail = min_scalar(data + i, length - i);
+    return (tail < min) ? tail : min;
+}
+
+__attribute__((target("sse4.1")))
+static int max_sse41(const int* data, int length) {
+    __m128i acc = _mm_set1_epi32(INT_MIN);
+    int i = 0;
+    for (; i + 4 <= length; i += 4) {
+        acc = _mm_max_epi32(acc, _mm_loadu_si128((const __m128i*)(data + i)));
+    }
+    acc = _mm_max_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_max_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    int max = _mm_cvtsi128_si32(acc);
+    int tail = max_scalar(data + i, length - i);
+    return (tail > max) ? tail : max;
+}
+
+__attribute__((target("avx2")))
+static int64_t sum_avx2(const int* data, int length) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= length; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    __m256i acc = _mm256_add_epi64(acc0, acc1);
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    int64_t sum = _mm_cvtsi128_si64(half) + _mm_extract_epi64(half, 1);
+    return sum + sum_scalar(data + i, length - i);
+}
+
+__attribute__((target("avx2")))
+static int min_avx2(const int* data, int length) {
+    __m256i acc = _mm256_set1_epi32(INT_MAX);
+    int i = 0;
+    for (; i + 8 <= length; i += 8) {
+        acc = _mm256_min_epi32(acc, _mm256_loadu_si256((const __m256i*)(data + i)));
+    }
+    __m128i half = _mm_min_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_min_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    int min = _mm_cvtsi128_si32(half);
+    int tail = min_scalar(data + i, length - i);
+    return (tail < min) ? tail : min;
+}
+
+__attribute__((target("avx2")))
+static int max_avx2(const int* data, int length) {
+    __m256i acc = _mm256_set1_epi32(INT_MIN);
+    int i = 0;
+    for (; i + 8 <= length; i += 8) {
+        acc = _mm256_max_epi32(acc, _mm256_loadu_si256((const __m256i*)(data + i)));
+    }
+    __m128i half = _mm_max_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    int max = _mm_cvtsi128_si32(half);
+    int tail = max_scalar(data + i, length - i);
+    return (tail > max) ? tail : max;
+}
+
+__attribute__((target("avx512f")))
+static int64_t sum_avx512(const int* data, int length) {
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m512i v = _mm512_loadu_si512((const void*)(data + i));
+        acc0 = _mm512_add_epi64(acc0, _mm512_cvtepi32_epi64(_mm512_castsi512_si256(v)));
+        acc1 = _mm512_add_epi64(acc1, _mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    int64_t sum = _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1));
+    return sum + sum_scalar(data + i, length - i);
+}
+
+__attribute__((target("avx512f")))
+static int min_avx512(const int* data, int length) {
+    __m512i acc = _mm512_set1_epi32(INT_MAX);
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        acc = _mm512_min_epi32(acc, _mm512_loadu_si512((const void*)(data + i)));
+    }
+    int min = _mm512_reduce_min_epi32(acc);
+    int tail = min_scalar(data + i, length - i);
+    return (tail < min) ? tail : min;
+}
+
+__attribute__((target("avx512f")))
+static int max_avx512(const int* data, int length) {
+    __m512i acc = _mm512_set1_epi32(INT_MIN);
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        acc = _mm512_max_epi32(acc, _mm512_loadu_si512((const void*)(data + i)));
+    }
+    int max = _mm512_reduce_max_epi32(acc);
+    int tail = max_scalar(data + i, length - i);
+    return (tail > max) ? tail : max;
+}
+#endif
+
+void select_reduction_kernels(void) {
+#if defined(__x86_64__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        reduction_kernels = (ReductionKernels){"avx512", sum_avx512, min_avx512, max_avx512};
+    } else if (__builtin_cpu_supports("avx2")) {
+        reduction_kernels = (ReductionKernels){"avx2", sum_avx2, min_avx2, max_avx2};
+    } else if (__builtin_cpu_supports("sse4.1")) {
+        reduction_kernels = (ReductionKernels){"sse4.1", sum_sse41, min_sse41, max_sse41};
+    }
+#endif
+    printf("Using %s reduction kernels\n", reduction_kernels.name);
+}
+
+// ==================== Parallel Local Reductions ====================
+
+typedef struct {
+    const int* data;
+    int length;
+    int task_count;
+    int64_t* partials;
+} ReduceTask;
+
+static void slice_bounds(int length, int task_count, int index, int* start, int* end) {
+    *start = (int)((long)length * index / task_count);
+    *end = (int)((long)length * (index + 1) / task_count);
+}
+
+static void sum_task(void* arg, int index) {
+    ReduceTask* t = arg;
+    int start, end;
+    slice_bounds(t->length, t->task_count, index, &start, &end);
+    t->partials[index] = reduction_kernels.sum(t->data + start, end - start);
+}
+
+static void min_task(void* arg, int index) {
+    ReduceTask* t = arg;
+    int start, end;
+    slice_bounds(t->length, t->task_count, index, &start, &end);
+    t->partials[index] = reduction_kernels.min(t->data + start, end - start);
+}
+
+static void max_task(void* arg, int index) {
+    ReduceTask* t = arg;
+    int start, end;
+    slice_bounds(t->length, t->task_count, index, &start, &end);
+    t->partials[index] = reduction_kernels.max(t->data + start, end - start);
+}
+
+static int64_t parallel_reduce(const int* data, int length, ParallelTask task,
+                               int64_t (*op)(int64_t, int64_t), int64_t identity) {
+    int task_count = parallel_task_count(length);
+    int64_t* partials = malloc(task_count * sizeof(int64_t));
+    ReduceTask t = {data, length, task_count, partials};
+    thread_pool_run(thread_pool, task, &t, task_count);
+    
+    int64_t result = identity;
+    for (int i = 0; i < task_count; i++) {
+        result = op(result, partials[i]);
+    }
+    free(partials);
+    return result;
+}
+
+int64_t parallel_sum(const int* data, int length) {
+    return parallel_reduce(data, length, sum_task, sum_op, 0);
+}
+
+int parallel_min(const int* data, int length) {
+    return (int)parallel_reduce(data, length, min_task, min_op, INT_MAX);
+}
+
+int parallel_max(const int* data, int length) {
+    return (int)parallel_reduce(data, length, max_task, max_op, INT_MIN);
+}
+
+// Parallel merge sort: every task quick-sorts one slice, then adjacent
+// runs are merged pairwise in log(tasks) parallel passes.
+typedef struct {
+    int* src;
+    int* dst;
+    int* bounds;   // Run i is [bounds[i], bounds[i + 1])
+    int run_count;
+    int width;     // Runs per merged output in this pass, halved
+} SortTask;
+
+static void sort_slice_task(void* arg, int index) {
+    SortTask* t = arg;
+    quick_sort(&t->src[t->bounds[index]], t->bounds[index + 1] - t->bounds[index]);
+}
+
+static void merge_pass_task(void* arg, int index) {
+    SortTask* t = arg;
+    int first = index * 2 * t->width;
+    int middle = first + t->width;
+    int last = first + 2 * t->width;
+    if (middle > t->run_count) middle = t->run_count;
+    if (last > t->run_count) last = t->run_count;
+    
+    int a = t->bounds[first], a_end = t->bounds[middle];
+    int b = a_end, b_end = t->bounds[last];
+    int k = a;
+    while (a < a_end && b < b_end) {
+        t->dst[k++] = (t->src[b] < t->src[a]) ? t->src[b++] : t->src[a++];
+    }
+    while (a < a_end) t->dst[k++] = t->src[a++];
+    while (b < b_end) t->dst[k++] = t->src[b++];
+}
+
+void parallel_sort(int* data, int length) {
+    int task_count = parallel_task_count(length);
+    if (task_count <= 1) {
+        quick_sort(data, length);
+        return;
+    }
+    
+    int* bounds = malloc((task_count + 1) * sizeof(int));
+    for (int i = 0; i <= task_count; i++) {
+        bounds[i] = (int)((long)length * i / task_count);
+    }
+    int* buffer = malloc(length * sizeof(int));
+    SortTask t = {data, buffer, bounds, task_count, 1};
+    thread_pool_run(thread_pool, sort_slice_task, &t, task_count);
+    
+    for (t.width = 1; t.width < task_count; t.width *= 2) {
+        int merges = (task_count + 2 * t.width - 1) / (2 * t.width);
+        thread_pool_run(thread_pool, merge_pass_task, &t, merges);
+        int* tmp = t.src;
+        t.src = t.dst;
+        t.dst = tmp;
+    }
+    
+    if (t.src != data) {
+        memcpy(data, t.src, length * sizeof(int));
+    }
+    free(buffer);
+    free(bounds);
+}
+
+// ==================== Memory-Mapped Datasets ====================
+
+// Maps a file of native ints read-only. Pages are faulted in while the
+// scatter streams them out, nothing is copied into the heap first.
+bool map_input_file(const char* path, MappedArray* map) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size % sizeof(int) != 0 ||
+        st.st_size / sizeof(int) > INT_MAX) {
+        fprintf(stderr, "%s: size must be a multiple of %zu bytes and at most INT_MAX elements\n",
+                path, sizeof(int));
+        close(fd);
+        return false;
+    }
+    
+    map->data = NULL;
+    map->size = st.st_size;
+    map->length = st.st_size / sizeof(int);
+    if (map->size > 0) {
+        map->data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map->data == MAP_FAILED) {
+            perror("mmap");
+            map->data = NULL;
+            close(fd);
+            return false;
+        }
+        madvise(map->data, map->size, MADV_SEQUENTIAL);
+    }
+    
+    close(fd);
+    return true;
+}
+
+// Creates or truncates path to length ints and maps it writable
+bool map_output_file(const char* path, int length, MappedArray* map) {
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+    
+    map->data = NULL;
+    map->length = length;
+    map->size = (size_t)length * sizeof(int);
+    if (ftruncate(fd, map->size) < 0) {
+        perror("ftruncate");
+        close(fd);
+        map->size = 0;
+        return false;
+    }
+    if (map->size > 0) {
+        map->data = mmap(NULL, map->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map->data == MAP_FAILED) {
+            perror("mmap");
+            map->data = NULL;
+            map->size = 0;
+            close(fd);
+            return false;
+        }
+    }
+    
+    close(fd);
+    return true;
+}
+
+void unmap_array(MappedArray* map) {
+    if (map->data) munmap(map->data, map->size);
+    map->data = NULL;
+    map->length = 0;
+    map->size = 0;
+}
+
+// Final step of SORT and SAMPLESORT on all ranks. The root receives each
+// rank's chunk at its offset, inside the --output mapping when one is
+// open for this job, otherwise in a fresh heap array.
+int* gather_sorted_result(Communicator* comm, int* data, int length) {
+    int total = (int)reduce_int(comm, length, sum_op);
+    
+    if (comm->is_root) {
+        int* result = output_array.data;
+        if (!result || output_array.length != total) {
+            result = malloc((total > 0 ? total : 1) * sizeof(int));
+        }
+        gather_into(comm, data, length, result, total);
+        return result;
+    } else {
+        gather_into(comm, data, length, NULL, 0);
+        return NULL;
+    }
+}
+
+// ==================== Utility Functions ====================
+
+int* create_random_array(int length) {
+    int* array = malloc(length * sizeof(int));
+    srand(time(NULL));
+    for (int i = 0; i < length; i++) {
+        array[i] = (rand() % 99) + 1;
+    }
+    return array;
+}
+
+int* calculate_chunk_sizes(int array_length, int num_processes) {
+    int* sizes = malloc(num_processes * sizeof(int));
+    int base_size = array_length / num_processes;
+    int remainder = array_length % num_processes;
+    
+    for (int i = 0; i < num_processes; i++) {
+        sizes[i] = base_size;
+        if (i < remainder) {
+            sizes[i]++;
+        }
+    }
+    
+    return sizes;
+}
+
+// QuickSort implementation
+void quick_sort_recursive(int* arr, int low, int high);
+int partition(int* arr, int low, int high);
+void swap(int* a, int* b);
+
+void quick_sort(int* arr, int length) {
+    quick_sort_recursive(arr, 0, length - 1);
+}
+
+void quick_sort_recursive(int* arr, int low, int high) {
+    if (low < high) {
+        int pivot_index = partition(arr, low, high);
+        quick_sort_recursive(arr, low, pivot_index - 1);
+        quick_sort_recursive(arr, pivot_index + 1, high);
+    }
+}
+
+int partition(int* arr, int low, int high) {
+    // Median-of-three pivot selection
+    int mid = low + (high - low) / 2;
+    if (arr[mid] < arr[low]) swap(&arr[low], &arr[mid]);
+    if (arr[high] < arr[low]) swap(&arr[low], &arr[high]);
+    if (arr[high] < arr[mid]) swap(&arr[mid], &arr[high]);
+    swap(&arr[mid], &arr[high]);
+    
+    int pivot = arr[high];
+    int i = low - 1;
+    
+    for (int j = low; j < high; j++) {
+        if (arr[j] <= pivot) {
+            i++;
+            swap(&arr[i], &arr[j]);
+        }
+    }
+    swap(&arr[i + 1], &arr[high]);
+    return i + 1;
+}
+
+void swap(int* a, int* b) {
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+void insert_from_left(int* arr, int length) {
+    int i = 0;
+    int temp = arr[i];
+    while (i + 1 < length && temp > arr[i + 1]) {
+        arr[i] = arr[i + 1];
+        i++;
+    }
+    arr[i] = temp;
+}
+
+void insert_from_right(int* arr, int length) {
+    int i = length - 1;
+    int temp = arr[i];
+    while (i - 1 >= 0 && temp < arr[i - 1]) {
+        arr[i] = arr[i - 1];
+        i--;
+    }
+    arr[i] = temp;
+}
+
+// Merge two sorted arrays and keep the smallest `length` elements in arr
+void merge_keep_low(int* arr, int length, const int* other, int other_length, int* scratch) {
+    int i = 0, j = 0;
+    for (int k = 0; k < length; k++) {
+        if (j >= other_length || (i < length && arr[i] <= other[j])) {
+            scratch[k] = arr[i++];
+        } else {
+            scratch[k] = other[j++];
+        }
+    }
+    memcpy(arr, scratch, length * sizeof(int));
+}
+
+// Merge two sorted arrays and keep the largest `length` elements in arr
+void merge_keep_high(int* arr, int length, const int* other, int other_length, int* scratch) {
+    int i = length - 1, j = other_length - 1;
+    for (int k = length - 1; k >= 0; k--) {
+        if (j < 0 || (i >= 0 && arr[i] > other[j])) {
+            scratch[k] = arr[i--];
+        } else {
+            scratch[k] = other[j--];
+        }
+    }
+    memcpy(arr, scratch, length * sizeof(int));
+}
+
+// K-way merge of consecutive sorted runs in data into out, using a
+// min-heap of run indices keyed by each run's current head
+void merge_runs(int* data, int* run_lengths, int run_count, int* out) {
+    int* pos = malloc((run_count > 0 ? run_count : 1) * sizeof(int));
+    int* end = malloc((run_count > 0 ? run_count : 1) * sizeof(int));
+    int* heap = malloc((run_count > 0 ? run_count : 1) * sizeof(int));
+    int heap_size = 0;
+    
+    int offset = 0;
+    for (int r = 0; r < run_count; r++) {
+        pos[r] = offset;
+        offset += run_lengths[r];
+        end[r] = offset;
+        if (run_lengths[r] > 0) heap[heap_size++] = r;
+    }
+    
+    // Heapify
+    for (int start = heap_size / 2 - 1; start >= 0; start--) {
+        int i = start;
+        while (2 * i + 1 < heap_size) {
+            int child = 2 * i + 1;
+            if (child + 1 < heap_size && data[pos[heap[child + 1]]] < data[pos[heap[child]]]) child++;
+            if (data[pos[heap[i]]] <= data[pos[heap[child]]]) break;
+            int tmp = heap[i]; heap[i] = heap[child]; heap[child] = tmp;
+            i = child;
+        }
+    }
+    
+    int k = 0;
+    while (heap_size > 0) {
+        int r = heap[0];
+        out[k++] = data[pos[r]++];
+        if (pos[r] == end[r]) {
+            heap[0] = heap[--heap_size];
+        }
+        
+        // Sift down the new top
+        int i = 0;
+        while (2 * i + 1 < heap_size) {
+            int child = 2 * i + 1;
+            if (child + 1 < heap_size && data[pos[heap[child + 1]]] < data[pos[heap[child]]]) child++;
+            if (data[pos[heap[i]]] <= data[pos[heap[child]]]) break;
+            int tmp = heap[i]; heap[i] = heap[child]; heap[child] = tmp;
+            i = child;
+        }
+    }
+    
+    free(pos);
+    free(end);
+    free(heap);
+}
+
+// First index in [low, high) whose value is greater than value
+int upper_bound(const int* arr, int low, int high, int value) {
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (arr[mid] <= value) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+const char* sort_mode_name(SortMode mode) {
+    return (mode == SORT_MODE_ELEMENT) ? "ELEMENT" : "BLOCK";
+}
+
+// Validation functions
+bool validate_sum(int64_t calculated_sum, int* original_array, int length) {
+    int64_t expected_sum = 0;
+    for (int i = 0; i < length; i++) {
+        expected_sum += original_array[i];
+    }
+    return calculated_sum == expected_sum;
+}
+
+bool validate_min(int calculated_min, int* original_array, int length) {
+    int expected_min = original_array[0];
+    for (int i = 1; i < length; i++) {
+        if (original_array[i] < expected_min) {
+            expected_min = original_array[i];
+        }
+    }
+    return calculated_min == expected_min;
+}
+
+bool validate_max(int calculated_max, int* original_array, int length) {
+    int expected_max = original_array[0];
+    for (int i = 1; i < length; i++) {
+        if (original_array[i] > expected_max) {
+            expected_max = original_array[i];
+        }
+    }
+    return calculated_max == expected_max;
+}
+
+bool is_sorted(int* array, int length) {
+    for (int i = 0; i < length - 1; i++) {
+        if (array[i] > array[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Helper operation functions
+int64_t min_op(int64_t a, int64_t b) {
+    return (a < b) ? a : b;
+}
+
+int64_t max_op(int64_t a, int64_t b) {
+    return (a > b) ? a : b;
+}
+
+int64_t sum_op(int64_t a, int64_t b) {
+    return a + b;
+}
+
+// Cleanup functions
+void free_coordinator_result(CoordinatorResult* result) {
+    if (result) {
+        free(result->sockets);
+        free(result->worker_infos);
+        free(result);
+    }
+}
+
+void free_worker_connection(WorkerConnection* conn) {
+    if (conn) {
+        free(conn->peer_infos);
+        free(conn);
+    }
+}
+